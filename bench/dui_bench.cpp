@@ -0,0 +1,345 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string>
+#include <vector>
+#include <SDL.h>
+#include "dui.hpp"
+
+// Reproducible scenarios to measure how long building and rendering frames
+// take. Results are only meaningful with optimizations enabled.
+//
+// Usage: dui_bench [scenario name filter] [--frames N]
+
+// Heap allocations, counted to check frames settle on none
+static size_t allocations = 0;
+
+void*
+operator new(size_t size)
+{
+  ++allocations;
+  if (void* p = std::malloc(size ? size : 1)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+void
+operator delete(void* p) noexcept
+{
+  std::free(p);
+}
+
+void
+operator delete(void* p, size_t) noexcept
+{
+  std::free(p);
+}
+
+namespace {
+
+constexpr int SCREEN_WIDTH = 800;
+constexpr int SCREEN_HEIGHT = 600;
+
+/// Ids and values the elements need, allocated before measuring
+struct Data
+{
+  std::vector<std::string> ids;
+  std::vector<std::string> strings;
+  std::vector<int> ints;
+  std::vector<double> doubles;
+  std::vector<SDL_Point> offsets;
+
+  Data(size_t count)
+    : strings(count, "Some text")
+    , ints(count)
+    , doubles(count, 0.5)
+    , offsets(count, SDL_Point{0, 0})
+  {
+    for (size_t i = 0; i < count; ++i) {
+      ids.push_back("e" + std::to_string(i));
+      ints[i] = i % 100;
+    }
+  }
+};
+
+struct Scenario
+{
+  const char* name;
+  size_t elements;
+  /// Height of the root group, 0 to grow it until every element fits in
+  int height;
+  /// Builds the elements and returns how many of them could be seen
+  size_t (*build)(dui::Target target, Data& data, size_t count, int height);
+};
+
+/// Whether the element added to target after caret was inside its visible area
+bool
+emitted(dui::Target target, SDL_Point caret)
+{
+  SDL_Point end = target.getCaret();
+  SDL_Rect r{caret.x,
+             caret.y,
+             std::max(end.x - caret.x, 1),
+             std::max(end.y - caret.y, 1)};
+  return target.isVisible(r);
+}
+
+size_t
+labels(dui::Target target, Data& data, size_t count, int height)
+{
+  auto g = dui::group(target, "root", {0, 0, SCREEN_WIDTH, height});
+  dui::Target root = g;
+  size_t visible = 0;
+  for (size_t i = 0; i < count; ++i) {
+    auto caret = root.getCaret();
+    dui::label(g, data.ids[i]);
+    visible += emitted(root, caret);
+  }
+  g.end();
+  return visible;
+}
+
+void
+nestedLevel(dui::Target target, Data& data, size_t level, size_t count)
+{
+  if (level == count) {
+    return;
+  }
+  auto& id = data.ids[level];
+  switch (level % 3) {
+    case 0:
+      if (auto g = dui::panel(target, id)) {
+        dui::label(g, id);
+        nestedLevel(g, data, level + 1, count);
+      }
+      break;
+    case 1:
+      if (auto g = dui::window(target, id)) {
+        dui::label(g, id);
+        nestedLevel(g, data, level + 1, count);
+      }
+      break;
+    default:
+      if (auto g = dui::scrollable(target, id, &data.offsets[level])) {
+        dui::label(g, id);
+        nestedLevel(g, data, level + 1, count);
+      }
+      break;
+  }
+}
+
+size_t
+nested(dui::Target target, Data& data, size_t count, int)
+{
+  nestedLevel(target, data, 0, count);
+  return count;
+}
+
+size_t
+panels(dui::Target target, Data& data, size_t count, int height)
+{
+  auto g = dui::group(target, "root", {0, 0, SCREEN_WIDTH, height});
+  dui::Target root = g;
+  size_t visible = 0;
+  for (size_t i = 0; i < count; ++i) {
+    auto caret = root.getCaret();
+    auto p = dui::panel(g, data.ids[i]);
+    dui::label(p, data.ids[i]);
+    p.end();
+    visible += emitted(root, caret);
+  }
+  g.end();
+  return visible;
+}
+
+size_t
+buttons(dui::Target target, Data& data, size_t count, int height)
+{
+  auto g = dui::group(target, "root", {0, 0, SCREEN_WIDTH, height});
+  dui::Target root = g;
+  size_t visible = 0;
+  for (size_t i = 0; i < count; ++i) {
+    auto caret = root.getCaret();
+    dui::button(g, data.ids[i]);
+    visible += emitted(root, caret);
+  }
+  g.end();
+  return visible;
+}
+
+size_t
+inputBoxes(dui::Target target, Data& data, size_t count, int height)
+{
+  auto g = dui::group(target, "root", {0, 0, SCREEN_WIDTH, height});
+  dui::Target root = g;
+  size_t visible = 0;
+  for (size_t i = 0; i < count; ++i) {
+    auto caret = root.getCaret();
+    switch (i % 3) {
+      case 0:
+        dui::textBox(g, data.ids[i], &data.strings[i]);
+        break;
+      case 1:
+        dui::numberBox(g, data.ids[i], &data.ints[i]);
+        break;
+      default:
+        dui::numberBox(g, data.ids[i], &data.doubles[i]);
+        break;
+    }
+    visible += emitted(root, caret);
+  }
+  g.end();
+  return visible;
+}
+
+size_t
+sliders(dui::Target target, Data& data, size_t count, int height)
+{
+  auto g = dui::group(target, "root", {0, 0, SCREEN_WIDTH, height});
+  dui::Target root = g;
+  size_t visible = 0;
+  for (size_t i = 0; i < count; ++i) {
+    auto caret = root.getCaret();
+    dui::sliderBox(g, data.ids[i], &data.ints[i], 0, 100);
+    visible += emitted(root, caret);
+  }
+  g.end();
+  return visible;
+}
+
+// The screen sized scenarios measure how well elements out of sight are
+// culled, the "_all" ones how long it takes when every element is seen.
+const Scenario scenarios[] = {
+  {"labels_1k", 1000, SCREEN_HEIGHT, labels},
+  {"labels_1k_all", 1000, 0, labels},
+  {"labels_10k", 10000, SCREEN_HEIGHT, labels},
+  {"labels_10k_all", 10000, 0, labels},
+  {"nested_30", 30, 0, nested},
+  {"nested_150", 150, 0, nested},
+  {"panels_1k", 1000, SCREEN_HEIGHT, panels},
+  {"panels_1k_all", 1000, 0, panels},
+  {"buttons_1k", 1000, SCREEN_HEIGHT, buttons},
+  {"buttons_1k_all", 1000, 0, buttons},
+  {"input_boxes_1k", 1000, SCREEN_HEIGHT, inputBoxes},
+  {"input_boxes_1k_all", 1000, 0, inputBoxes},
+  {"sliders_1k", 1000, SCREEN_HEIGHT, sliders},
+  {"sliders_1k_all", 1000, 0, sliders},
+};
+
+double
+secondsSince(Uint64 start)
+{
+  return double(SDL_GetPerformanceCounter() - start) /
+         SDL_GetPerformanceFrequency();
+}
+
+/// Best of all runs, to reduce the noise from the rest of the system
+struct Timing
+{
+  double best = 0;
+
+  void add(double seconds)
+  {
+    if (best == 0 || seconds < best) {
+      best = seconds;
+    }
+  }
+};
+
+void
+run(const Scenario& scenario, int frames)
+{
+  Data data{scenario.elements};
+
+  dui::SoftRenderer softRenderer{SCREEN_WIDTH, SCREEN_HEIGHT};
+  dui::State softState{dui::loadDefaultFont(softRenderer)};
+
+  SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormat(
+    0, SCREEN_WIDTH, SCREEN_HEIGHT, 32, SDL_PIXELFORMAT_RGBA32);
+  SDL_Renderer* sdlRenderer = SDL_CreateSoftwareRenderer(surface);
+  dui::State sdlState{sdlRenderer};
+
+  Timing build, softRender, sdlRender;
+  size_t listSize = 0;
+  size_t frameAllocations = 0;
+  size_t visible = 0;
+  for (int i = 0; i < frames; ++i) {
+    size_t allocationsBefore = allocations;
+    Uint64 start = SDL_GetPerformanceCounter();
+    auto f = dui::frame(softState);
+    visible = scenario.build(f, data, scenario.elements, scenario.height);
+    f.end();
+    build.add(secondsSince(start));
+    frameAllocations = allocations - allocationsBefore;
+    listSize = softState.displayListSize();
+
+    start = SDL_GetPerformanceCounter();
+    softRenderer.clear({255, 255, 255, 255});
+    softState.render(softRenderer);
+    softRender.add(secondsSince(start));
+
+    auto f2 = dui::frame(sdlState);
+    scenario.build(f2, data, scenario.elements, scenario.height);
+    f2.end();
+    start = SDL_GetPerformanceCounter();
+    SDL_SetRenderDrawColor(sdlRenderer, 255, 255, 255, 255);
+    SDL_RenderClear(sdlRenderer);
+    sdlState.render();
+    SDL_RenderPresent(sdlRenderer);
+    sdlRender.add(secondsSince(start));
+  }
+  SDL_DestroyRenderer(sdlRenderer);
+  SDL_FreeSurface(surface);
+
+  printf("%-18s %8zu %8zu %12.1f %10zu %8zu %14.3f %14.3f\n",
+         scenario.name,
+         scenario.elements,
+         visible,
+         build.best * 1e9 / scenario.elements,
+         listSize,
+         frameAllocations,
+         softRender.best * 1e3,
+         sdlRender.best * 1e3);
+}
+
+} // namespace
+
+int
+main(int argc, char** argv)
+{
+  const char* filter = nullptr;
+  int frames = 20;
+  for (int i = 1; i < argc; ++i) {
+    if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+      frames = std::max(1, atoi(argv[++i]));
+    } else {
+      filter = argv[i];
+    }
+  }
+
+  // No video subsystem is needed for the software renderers
+  if (SDL_Init(0) < 0) {
+    fprintf(stderr, "%s\n", SDL_GetError());
+    return 1;
+  }
+
+  printf("%-18s %8s %8s %12s %10s %8s %14s %14s\n",
+         "scenario",
+         "elements",
+         "emitted",
+         "build ns/el",
+         "list size",
+         "allocs",
+         "soft render ms",
+         "SDL render ms");
+  for (auto& scenario : scenarios) {
+    if (!filter || strstr(scenario.name, filter)) {
+      run(scenario, frames);
+    }
+  }
+  SDL_Quit();
+  return 0;
+}
@@ -39,8 +39,10 @@ main(int argc, char** argv)
   constexpr size_t str1Size = 100;
   char str1[str1Size] = "str1";
   std::string str2 = "str2";
+  dui::TextBuffer notes{"Multi line\ntext"};
   int value1 = 42;
   double value2 = 11.25;
+  bool showPerf = false;
 
   std::string basePath = SDL_GetBasePath();
   SDL_Surface* surface = SDL_LoadBMP((basePath + "../dui.bmp").c_str());
@@ -50,16 +52,24 @@ main(int argc, char** argv)
 
   for (;;) {
     SDL_Event ev;
-    while (SDL_PollEvent(&ev)) {
+    while (state.waitEvent(&ev)) {
       state.event(ev);
       if (ev.type == SDL_QUIT) {
         return 0;
       }
+      if (ev.type == SDL_KEYDOWN && ev.key.keysym.sym == SDLK_F1) {
+        showPerf = !showPerf;
+      }
     }
 
     // UI
     auto f = dui::frame(state);
 
+    // Performance overlay, toggled by F1. Added first so it is on top
+    if (showPerf) {
+      dui::perfOverlay(f, {320, 440});
+    }
+
     // Free label
     dui::label(f, "Hello world", {320, 10});
 
@@ -134,6 +144,7 @@ main(int argc, char** argv)
     dui::label(p, "Text input", {0, 10});
     dui::textField(p, "Str1", str1, str1Size);
     dui::textField(p, "Str2", &str2);
+    dui::textArea(p, "notes", &notes, {0, 0, 200, 44});
 
     // numeric input examples
     dui::label(p, "Number input", {0, 10});
@@ -165,14 +176,16 @@ main(int argc, char** argv)
     // For example, we can add this big texture
     dui::textureBox(f, texture, {400, 300, 256, 256});
 
-    // Render
-    SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
-    SDL_RenderFillRect(renderer, nullptr);
+    // Render, if anything changed
+    f.end();
+    if (state.isDirty()) {
+      SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
+      SDL_RenderFillRect(renderer, nullptr);
 
-    f.render();
+      state.render();
 
-    SDL_RenderPresent(renderer);
-    SDL_Delay(1);
+      SDL_RenderPresent(renderer);
+    }
   }
   return 1;
 }
@@ -40,7 +40,7 @@ main(int argc, char** argv)
     bool keyboardFocus = state.wantsKeyboard();
 
     SDL_Event ev;
-    while (SDL_PollEvent(&ev)) {
+    while (state.waitEvent(&ev)) {
       state.event(ev);
       if (ev.type == SDL_QUIT) {
         return 0;
@@ -62,14 +62,16 @@ main(int argc, char** argv)
       dui::textField(p, "dummy text", &dummyText);
     }
 
-    // Render
-    SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
-    SDL_RenderFillRect(renderer, nullptr);
+    // Render, if anything changed
+    f.end();
+    if (state.isDirty()) {
+      SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
+      SDL_RenderFillRect(renderer, nullptr);
 
-    f.render();
+      state.render();
 
-    SDL_RenderPresent(renderer);
-    SDL_Delay(1);
+      SDL_RenderPresent(renderer);
+    }
   }
   return 1;
 }
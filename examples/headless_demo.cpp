@@ -0,0 +1,61 @@
+#include <fstream>
+#include <iterator>
+#include <vector>
+#include <SDL.h>
+#include "dui.hpp"
+
+int
+main(int argc, char** argv)
+{
+  const char* fileName = argc > 1 ? argv[1] : "headless_demo.bmp";
+  const char* fontName = argc > 2 ? argv[2] : nullptr;
+
+  // Init SDL, no video needed
+  if (SDL_Init(0) < 0) {
+    fprintf(stderr, "%s\n", SDL_GetError());
+    return 1;
+  }
+
+  // Create the software renderer and an ui state using it
+  dui::SoftRenderer renderer{320, 240};
+  dui::State state{dui::loadDefaultFont(renderer)};
+
+  // Optionally use a TrueType font
+  std::vector<char> fontData;
+  if (fontName) {
+    std::ifstream file{fontName, std::ios::binary};
+    fontData.assign(std::istreambuf_iterator<char>{file}, {});
+  }
+  dui::TrueTypeFont ttf{renderer, fontData.data(), fontData.size(), 16};
+  if (fontName && !ttf.isValid()) {
+    fprintf(stderr, "Could not load %s\n", fontName);
+    return 1;
+  }
+  if (ttf.isValid()) {
+    state.setFont(ttf.font());
+  }
+
+  // Build a single frame
+  auto f = dui::frame(state);
+  auto p = dui::panel(f, "panel", {10, 10, 300, 220});
+  dui::label(p, "Rendered without a display");
+  dui::button(p, "Button");
+  p.end();
+
+  // Render it
+  renderer.clear({255, 255, 255, 255});
+  f.render(renderer);
+
+  // Save it
+  auto pixels = const_cast<SDL_Color*>(renderer.getPixels());
+  int w = renderer.getWidth(), h = renderer.getHeight();
+  SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormatFrom(
+    pixels, w, h, 32, w * 4, SDL_PIXELFORMAT_RGBA32);
+  if (SDL_SaveBMP(surface, fileName) < 0) {
+    fprintf(stderr, "%s\n", SDL_GetError());
+    return 1;
+  }
+  SDL_FreeSurface(surface);
+  SDL_Quit();
+  return 0;
+}
@@ -24,9 +24,9 @@ main(int argc, char** argv)
 
   // Main loop
   for (;;) {
-    // Event handling
+    // Event handling, waiting while there is nothing new to show
     SDL_Event ev;
-    while (SDL_PollEvent(&ev)) {
+    while (state.waitEvent(&ev)) {
       // Send event to the state
       state.event(ev);
 
@@ -48,16 +48,21 @@ main(int argc, char** argv)
       SDL_PushEvent(&ev);
     }
 
-    // Clear screen
-    SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
-    SDL_RenderFillRect(renderer, nullptr);
+    // End frame
+    f.end();
 
-    // End frame and render state
-    f.render();
+    // Render only if something changed
+    if (state.isDirty()) {
+      // Clear screen
+      SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
+      SDL_RenderFillRect(renderer, nullptr);
 
-    // Present and wait a bit
-    SDL_RenderPresent(renderer);
-    SDL_Delay(1);
+      // Render state
+      state.render();
+
+      // Present
+      SDL_RenderPresent(renderer);
+    }
   }
   return 1;
 }
@@ -24,12 +24,13 @@ main(int argc, char** argv)
 
   // variables
   SDL_Point var1 = {0, 10};
+  SDL_Point listScroll = {0, 0};
 
   // Main loop
   for (;;) {
-    // Event handling
+    // Event handling, waiting while there is nothing new to show
     SDL_Event ev;
-    while (SDL_PollEvent(&ev)) {
+    while (state.waitEvent(&ev)) {
       // Send event to the state
       state.event(ev);
 
@@ -54,18 +55,37 @@ main(int argc, char** argv)
       }
     }
     dui::label(g, "End");
+
+    // A million rows, but only the visible ones are created
+    dui::virtualList(
+      g,
+      "bigList",
+      &listScroll,
+      1000000,
+      12,
+      [](dui::Target t, size_t i) {
+        char buffer[32];
+        SDL_snprintf(buffer, sizeof(buffer), "Row %u", unsigned(i));
+        dui::label(t, buffer);
+      },
+      {0, 0, 200, 150});
     g.end();
 
-    // Clear screen
-    SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
-    SDL_RenderFillRect(renderer, nullptr);
+    // End frame
+    f.end();
+
+    // Render only if something changed
+    if (state.isDirty()) {
+      // Clear screen
+      SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
+      SDL_RenderFillRect(renderer, nullptr);
 
-    // End frame and render state
-    f.render();
+      // Render state
+      state.render();
 
-    // Present and wait a bit
-    SDL_RenderPresent(renderer);
-    SDL_Delay(1);
+      // Present
+      SDL_RenderPresent(renderer);
+    }
   }
   return 1;
 }
@@ -27,7 +27,9 @@ colorBox(Target target, SDL_Rect rect, SDL_Color c)
   target.advance({rect.x + rect.w, rect.y + rect.h});
   rect.x += caret.x;
   rect.y += caret.y;
-  state.display(Shape::Box(rect, c));
+  if (target.isVisible(rect)) {
+    state.display(Shape::Box(rect, c));
+  }
 }
 
 /**
@@ -48,7 +50,9 @@ textureBox(Target target, SDL_Texture* texture, SDL_Rect rect)
   target.advance({rect.x + rect.w, rect.y + rect.h});
   rect.x += caret.x;
   rect.y += caret.y;
-  state.display(Shape::Texture(rect, texture));
+  if (target.isVisible(rect)) {
+    state.display(Shape::Texture(rect, texture));
+  }
 }
 
 /**
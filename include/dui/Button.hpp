@@ -33,7 +33,7 @@ buttonBase(Target target,
     str = id;
   }
   auto adv = elementSize(style.padding + style.border,
-                         measure(str, style.font, style.scale));
+                         measure(target, str, style.font, style.scale));
   SDL_Rect r{p.x, p.y, adv.x, adv.y};
   auto action = target.checkMouse(id, r);
 
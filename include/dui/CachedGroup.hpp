@@ -0,0 +1,112 @@
+#ifndef DUI_CACHED_GROUP_HPP_
+#define DUI_CACHED_GROUP_HPP_
+
+#include <string_view>
+#include <SDL.h>
+#include "Box.hpp"
+#include "Group.hpp"
+#include "GroupStyle.hpp"
+#include "Theme.hpp"
+
+namespace dui {
+
+/**
+ * @brief A group rendered once into a texture and then reused
+ * @ingroup groups
+ *
+ * While key stays the same the content is not called, and the texture with
+ * what it displayed is shown instead. Content is cached after it keeps the
+ * same key for two frames, and only if the whole group is visible. It should
+ * be static: anything interactive or animated inside stops working while
+ * cached.
+ *
+ * Without a renderer on State, or when the textures do not fit in the cache
+ * limit, content is just called every frame. See State::setGroupCacheLimit().
+ *
+ * @param target the parent group or frame
+ * @param id the group id
+ * @param key identifies the content, it must change whenever the content
+ * would display something different
+ * @param content the callback adding the elements, called as content(target)
+ * @param r the relative position and the size. If w or h is 0 it will auto
+ * size
+ * @param style
+ */
+template<class CONTENT>
+inline void
+cachedGroup(Target target,
+            std::string_view id,
+            Uint64 key,
+            CONTENT content,
+            const SDL_Rect& r = {0},
+            const GroupStyle& style = themeFor<Group>())
+{
+  auto& state = target.getState();
+  SDL_Point size;
+  if (auto texture = state.findCachedGroup(id, key, &size)) {
+    auto g = group(target, id, {r.x, r.y, size.x, size.y}, style);
+    textureBox(g, texture, {0, 0, size.x, size.y});
+    g.end();
+    return;
+  }
+  auto caret = target.getCaret();
+  size_t first = state.displayListSize();
+  auto g = group(target, id, r, style);
+  content(g);
+  SDL_Rect rect{caret.x + r.x, caret.y + r.y, g.width(), g.height()};
+  g.end();
+  SDL_Rect shown = clipVisible(target.getVisible(), rect);
+  if (SDL_RectEquals(&shown, &rect)) {
+    state.cacheGroup(id, key, first, rect);
+  }
+}
+
+/**
+ * @brief A group rendered into a texture while what it displays is the same
+ * @ingroup groups
+ *
+ * The content is called every frame, and the hash of what it displayed is
+ * used as key. This saves only rendering, but needs no key to be kept up to
+ * date.
+ *
+ * @param target the parent group or frame
+ * @param id the group id
+ * @param content the callback adding the elements, called as content(target)
+ * @param r the relative position and the size. If w or h is 0 it will auto
+ * size
+ * @param style
+ * @see cachedGroup(Target, std::string_view, Uint64, CONTENT, const SDL_Rect&,
+ * const GroupStyle&)
+ */
+template<class CONTENT>
+inline void
+cachedGroup(Target target,
+            std::string_view id,
+            CONTENT content,
+            const SDL_Rect& r = {0},
+            const GroupStyle& style = themeFor<Group>())
+{
+  auto& state = target.getState();
+  auto caret = target.getCaret();
+  size_t first = state.displayListSize();
+  auto g = group(target, id, r, style);
+  content(g);
+  SDL_Rect rect{caret.x + r.x, caret.y + r.y, g.width(), g.height()};
+  g.end();
+  SDL_Rect shown = clipVisible(target.getVisible(), rect);
+  if (!SDL_RectEquals(&shown, &rect)) {
+    return;
+  }
+  auto key = state.displayHash(first, {rect.x, rect.y});
+  SDL_Point size;
+  if (auto texture = state.findCachedGroup(id, key, &size)) {
+    state.undisplay(first);
+    state.display(Shape::Texture(rect, texture));
+  } else {
+    state.cacheGroup(id, key, first, rect);
+  }
+}
+
+} // namespace dui
+
+#endif // DUI_CACHED_GROUP_HPP_
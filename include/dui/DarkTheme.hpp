@@ -9,7 +9,11 @@ struct DarkTheme;
 } // namespace style
 } // namespace dui
 
+// Include it first to make it the default theme. If DUI_THEME is already set,
+// it is only used as runtimeTheme<DarkTheme>.
+#ifndef DUI_THEME
 #define DUI_THEME dui::style::DarkTheme
+#endif
 #include "BoxStyle.hpp"
 #include "ButtonStyle.hpp"
 #include "ElementStyle.hpp"
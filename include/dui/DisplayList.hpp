@@ -1,46 +1,18 @@
 #ifndef DUI_DISPLAY_LIST_HPP
 #define DUI_DISPLAY_LIST_HPP
 
+#include <string>
+#include <string_view>
 #include <vector>
 #include <SDL_rect.h>
 #include <SDL_render.h>
+#include "Font.hpp"
+#include "FrameStats.hpp"
+#include "RenderBackend.hpp"
+#include "Shape.hpp"
 
 namespace dui {
 
-struct Shape
-{
-  SDL_Texture* texture;
-  SDL_Rect rect;
-  SDL_Rect srcRect;
-  SDL_Color color;
-
-  static Shape Box(const SDL_Rect& r, SDL_Color c)
-  {
-    return {nullptr, r, {0}, c};
-  }
-  static Shape Texture(const SDL_Rect& r, SDL_Texture* texture)
-  {
-    return {texture, r, {0}, {255, 255, 255, 255}};
-  }
-  static Shape Texture(const SDL_Rect& r, SDL_Texture* texture, SDL_Color c)
-  {
-    return {texture, r, {0}, c};
-  }
-  static Shape Texture(const SDL_Rect& r,
-                       SDL_Texture* texture,
-                       SDL_Rect& srcRect)
-  {
-    return {texture, r, srcRect, {255, 255, 255, 255}};
-  }
-  static Shape Texture(const SDL_Rect& r,
-                       SDL_Texture* texture,
-                       SDL_Rect& srcRect,
-                       SDL_Color c)
-  {
-    return {texture, r, srcRect, c};
-  }
-};
-
 /**
  * @brief Contains the list of elements to render
  *
@@ -52,6 +24,19 @@ class DisplayList
     POP_CLIP,
     PUSH_CLIP,
     SHAPE,
+    TEXT,
+  };
+
+  // A text line, expanded into glyphs only when rendering
+  struct TextRun
+  {
+    Font font;
+    SDL_Point origin;
+    Uint32 offset; // The first character on chars
+    Uint32 length;
+    int width; // Already scaled
+    SDL_Color color;
+    int scale;
   };
 
   struct Command
@@ -60,6 +45,7 @@ class DisplayList
     {
       Shape shape;
       SDL_Rect rect;
+      TextRun text;
     };
     CommandType type;
 
@@ -74,13 +60,119 @@ class DisplayList
       : rect(rect)
       , type(PUSH_CLIP)
     {}
+    Command(const TextRun& text)
+      : text(text)
+      , type(TEXT)
+    {}
   };
+
+  // What a shape or text looked like on screen, to find what changed
+  struct DrawRecord
+  {
+    SDL_Rect bounds; // The visible area
+    Uint64 hash;     // The content, including the clip rect
+
+    bool operator==(const DrawRecord& rhs) const
+    {
+      return hash == rhs.hash && SDL_RectEquals(&bounds, &rhs.bounds);
+    }
+  };
+
   std::vector<Command> items;
+  std::string chars; // Storage for all text runs in this frame
+  SDLRenderBackend sdlBackend;
+  RenderStats stats;
+
+  // Canvas for render() with damaged areas
+  SDL_Texture* canvas = nullptr;
+  std::vector<DrawRecord> canvasRecords;
+  std::vector<DrawRecord> records;
+  std::vector<SDL_Rect> damage;
+
+  std::vector<SDL_Rect> clipStack; // Effective clip rects while rendering
+
+  std::string_view textOf(const TextRun& text) const
+  {
+    return std::string_view{chars}.substr(text.offset, text.length);
+  }
+
+  static SDL_Rect boundsOf(const Command& item)
+  {
+    if (item.type == SHAPE) {
+      return item.shape.rect;
+    }
+    SDL_assert(item.type == TEXT);
+    auto& text = item.text;
+    int h = text.font.charH << text.scale;
+    return {text.origin.x, text.origin.y, text.width, h};
+  }
+
+  Uint64 hashOf(const Command& item, Uint64 h = 14695981039346656037ull) const;
+
+  static Command translated(Command item, const SDL_Point& offset)
+  {
+    if (item.type == PUSH_CLIP) {
+      item.rect.x += offset.x;
+      item.rect.y += offset.y;
+    } else if (item.type == SHAPE) {
+      item.shape.rect.x += offset.x;
+      item.shape.rect.y += offset.y;
+    } else if (item.type == TEXT) {
+      item.text.origin.x += offset.x;
+      item.text.origin.y += offset.y;
+    }
+    return item;
+  }
+
+  template<class F>
+  void visit(const SDL_Rect* bounds, F f);
+
+  void renderItems(RenderBackend& backend, const SDL_Rect* bounds);
+
+  void renderText(RenderBackend& backend,
+                  const TextRun& text,
+                  const SDL_Rect* clip);
+
+  void addDamage(SDL_Rect rect);
 
 public:
-  void clear() { items.clear(); }
+  /// Maximum number of damaged areas redrawn separately
+  static constexpr size_t DAMAGE_MAX_COUNT = 8;
+
+  void clear()
+  {
+    items.clear();
+    chars.clear();
+  }
+
+  size_t size() const { return items.size(); }
 
-  size_t size() { return items.size(); }
+  /**
+   * @brief A hash of the content
+   *
+   * Two lists with the same hash are expected to render the same. Any single
+   * change in a command is guaranteed to change the hash.
+   */
+  Uint64 hash() const;
+
+  /// A hash of the commands from first on, as if moved by offset
+  Uint64 hash(size_t first, const SDL_Point& offset) const;
+
+  /**
+   * @brief Copy the commands from first on into another list
+   *
+   * @param out the list to copy to. It is cleared first
+   * @param first the index of the first command
+   * @param offset added to the positions of all commands
+   */
+  void copyTo(DisplayList& out, size_t first, const SDL_Point& offset) const;
+
+  /// Remove the commands from first on
+  void truncate(size_t first)
+  {
+    SDL_assert(first <= items.size());
+    items.erase(items.begin() + first, items.end());
+  }
 
   void insert(const Shape& item)
   {
@@ -89,9 +181,40 @@ public:
     }
   }
 
+  /**
+   * @brief Insert a single line of text
+   *
+   * The text is copied, so it does not need to outlive the frame.
+   *
+   * @param str the text
+   * @param p the top left position of the first character
+   * @param font the font. Must have a valid texture
+   * @param scale the text scale (0: 1x, 1: 2x, 2: 4x, and so on)
+   * @param color the text color
+   * @param width the text width, already scaled, as measured by the caller
+   */
+  void insertText(std::string_view str,
+                  const SDL_Point& p,
+                  const Font& font,
+                  int scale,
+                  SDL_Color color,
+                  int width)
+  {
+    if (color.a > 0 && !str.empty()) {
+      Uint32 offset = chars.size();
+      chars.append(str);
+      Uint32 length = str.size();
+      items.push_back(TextRun{font, p, offset, length, width, color, scale});
+    }
+  }
+
   void pushClip(const SDL_Rect& rect)
   {
-    // TODO coalesce multiple clips
+    if (!items.empty() && items.back().type == POP_CLIP) {
+      // Nothing between them, so they cancel out
+      items.pop_back();
+      return;
+    }
     if (rect.w > 0 && rect.h > 0) {
       items.push_back(rect);
     } else {
@@ -101,54 +224,355 @@ public:
 
   void popClip() { items.push_back({}); }
 
-  void render(SDL_Renderer* renderer) const;
+  /// Render on the given renderer's current target
+  void render(SDL_Renderer* renderer)
+  {
+    sdlBackend.setRenderer(renderer);
+    render(sdlBackend);
+  }
+
+  /// Render with the given backend
+  void render(RenderBackend& backend)
+  {
+    stats = {};
+    Uint32 drawCalls = backend.getDrawCalls();
+    backend.begin();
+    renderItems(backend, nullptr);
+    backend.end();
+    stats.drawCalls = backend.getDrawCalls() - drawCalls;
+  }
+
+  /**
+   * @brief Render into a persistent canvas, redrawing only what changed
+   *
+   * The list is compared with the one last rendered into the same canvas, and
+   * only the areas where they differ are cleared and redrawn. Then the whole
+   * canvas is copied to the current render target, at its top left corner.
+   *
+   * The canvas must be created with SDL_TEXTUREACCESS_TARGET and nothing
+   * else should draw on it. If a different canvas is given or its content is
+   * lost (SDL_RENDER_TARGETS_RESET), everything is redrawn.
+   *
+   * @param renderer the renderer
+   * @param canvas the texture holding the previous render
+   * @param background the color used to clear the damaged areas
+   */
+  void render(SDL_Renderer* renderer,
+              SDL_Texture* canvas,
+              SDL_Color background);
+
+  /// Force the next render() with canvas to redraw everything
+  void invalidateCanvas() { canvas = nullptr; }
+
+  /// What the last render() did
+  const RenderStats& renderStats() const { return stats; }
+
+  /// Areas redrawn on the last render() with canvas
+  const std::vector<SDL_Rect>& lastDamage() const { return damage; }
 };
 
+inline Uint64
+DisplayList::hashOf(const Command& item, Uint64 h) const
+{
+  auto mix = [&](Uint64 v) { h = (h ^ v) * 1099511628211ull; };
+  auto mixRect = [&](const SDL_Rect& r) {
+    mix(Uint64(Uint32(r.x)) << 32 | Uint32(r.y));
+    mix(Uint64(Uint32(r.w)) << 32 | Uint32(r.h));
+  };
+  auto mixColor = [&](SDL_Color c) {
+    mix(c.r | c.g << 8 | c.b << 16 | Uint32(c.a) << 24);
+  };
+  mix(item.type);
+  if (item.type == PUSH_CLIP) {
+    mixRect(item.rect);
+  } else if (item.type == SHAPE) {
+    mix(Uint64(uintptr_t(item.shape.texture)));
+    mixRect(item.shape.rect);
+    mixRect(item.shape.srcRect);
+    mixColor(item.shape.color);
+  } else if (item.type == TEXT) {
+    auto& text = item.text;
+    mix(Uint64(uintptr_t(text.font.texture)));
+    mix(Uint64(uintptr_t(text.font.glyphs)));
+    mixRect({text.font.charW, text.font.charH, text.font.cols, text.scale});
+    mix(Uint64(Uint32(text.origin.x)) << 32 | Uint32(text.origin.y));
+    mixColor(text.color);
+    mix(text.length);
+    for (Uint8 ch : textOf(text)) {
+      mix(ch);
+    }
+  }
+  return h;
+}
+
+inline Uint64
+DisplayList::hash() const
+{
+  Uint64 h = 14695981039346656037ull;
+  for (auto& item : items) {
+    h = hashOf(item, h);
+  }
+  return h;
+}
+
+inline Uint64
+DisplayList::hash(size_t first, const SDL_Point& offset) const
+{
+  Uint64 h = 14695981039346656037ull;
+  for (size_t i = first; i < items.size(); ++i) {
+    h = hashOf(translated(items[i], offset), h);
+  }
+  return h;
+}
+
 inline void
-DisplayList::render(SDL_Renderer* renderer) const
+DisplayList::copyTo(DisplayList& out,
+                    size_t first,
+                    const SDL_Point& offset) const
 {
+  out.clear();
+  for (size_t i = first; i < items.size(); ++i) {
+    Command item = translated(items[i], offset);
+    if (item.type == TEXT) {
+      auto str = textOf(item.text);
+      item.text.offset = out.chars.size();
+      out.chars.append(str);
+    }
+    out.items.push_back(item);
+  }
+}
+
+/// Calls f(item, clip) for each shape or text, in render order, with their
+/// effective clip rect (nullptr if not clipped).
+///
+/// The clip given is the outermost one cutting the item as much as its own,
+/// so items that fit in their groups share the clip of the first group that
+/// really cuts them, and render without changing it.
+template<class F>
+inline void
+DisplayList::visit(const SDL_Rect* bounds, F f)
+{
+  auto clipFor = [&](const SDL_Rect& rect) -> const SDL_Rect* {
+    if (clipStack.empty()) {
+      return bounds;
+    }
+    SDL_Rect visible;
+    if (!SDL_IntersectRect(&rect, &clipStack.back(), &visible)) {
+      return &clipStack.back();
+    }
+    for (size_t i = clipStack.size(); i > 0; --i) {
+      const SDL_Rect* parent = i > 1 ? &clipStack[i - 2] : bounds;
+      SDL_Rect shown = rect;
+      if (parent) {
+        SDL_IntersectRect(&rect, parent, &shown);
+      }
+      if (!SDL_RectEquals(&shown, &visible)) {
+        return &clipStack[i - 1];
+      }
+    }
+    return bounds;
+  };
+  clipStack.clear();
+  for (auto it = items.rbegin(); it != items.rend(); it++) {
+    if (it->type == POP_CLIP) {
+      SDL_assert(!clipStack.empty());
+      clipStack.pop_back();
+    } else if (it->type == PUSH_CLIP) {
+      SDL_Rect rect = it->rect;
+      const SDL_Rect* parent = clipStack.empty() ? bounds : &clipStack.back();
+      if (parent && !SDL_IntersectRect(&it->rect, parent, &rect)) {
+        rect = {parent->x, parent->y, 0, 0};
+      }
+      clipStack.push_back(rect);
+    } else {
+      f(*it, clipFor(boundsOf(*it)));
+    }
+  }
+  SDL_assert(clipStack.empty());
+}
+
+inline void
+DisplayList::render(SDL_Renderer* renderer,
+                    SDL_Texture* canvas,
+                    SDL_Color background)
+{
+  SDL_Rect canvasRect{0, 0, 0, 0};
+  SDL_QueryTexture(canvas, nullptr, nullptr, &canvasRect.w, &canvasRect.h);
+
+  records.clear();
+  visit(nullptr, [&](const Command& item, const SDL_Rect* clip) {
+    SDL_Rect bounds = boundsOf(item);
+    if (clip) {
+      SDL_IntersectRect(&bounds, clip, &bounds);
+    }
+    Uint64 h = hashOf(item);
+    h = hashOf(clip ? Command{*clip} : Command{}, h);
+    records.push_back({bounds, h});
+  });
+
+  damage.clear();
+  if (canvas != this->canvas) {
+    this->canvas = canvas;
+    SDL_SetTextureBlendMode(canvas, SDL_BLENDMODE_NONE);
+    damage.push_back(canvasRect);
+  } else {
+    // Only the range between the common head and tail is damaged
+    size_t head = 0;
+    size_t oldCount = canvasRecords.size(), newCount = records.size();
+    while (head < oldCount && head < newCount &&
+           canvasRecords[head] == records[head]) {
+      ++head;
+    }
+    size_t tail = 0;
+    while (tail < oldCount - head && tail < newCount - head &&
+           canvasRecords[oldCount - tail - 1] == records[newCount - tail - 1]) {
+      ++tail;
+    }
+    for (size_t i = head; i < oldCount - tail; ++i) {
+      addDamage(canvasRecords[i].bounds);
+    }
+    for (size_t i = head; i < newCount - tail; ++i) {
+      addDamage(records[i].bounds);
+    }
+  }
+  canvasRecords.swap(records);
+
   // Save render state
+  SDL_Texture* target = SDL_GetRenderTarget(renderer);
   SDL_BlendMode blendMode;
   SDL_GetRenderDrawBlendMode(renderer, &blendMode);
-  SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
 
-  // Stack
-  constexpr int STACK_MAX_SIZE = 32;
-  SDL_Rect stack[STACK_MAX_SIZE]; // TODO make this configurable
-  int stackSz = 0;
-  for (auto it = items.rbegin(); it != items.rend(); it++) {
-    if (it->type == POP_CLIP) {
-      SDL_assert(stackSz > 0);
-      --stackSz;
-      SDL_RenderSetClipRect(renderer,
-                            stackSz > 0 ? &stack[stackSz - 1] : nullptr);
+  stats = {};
+  Uint32 drawCalls = sdlBackend.getDrawCalls();
+  sdlBackend.setRenderer(renderer);
+  SDL_SetRenderTarget(renderer, canvas);
+  for (auto& rect : damage) {
+    SDL_Rect bounds;
+    if (!SDL_IntersectRect(&rect, &canvasRect, &bounds)) {
       continue;
     }
-    if (it->type == PUSH_CLIP) {
-      SDL_assert(stackSz < STACK_MAX_SIZE);
-      SDL_Rect rect = it->rect;
-      if (stackSz > 0) {
-        SDL_IntersectRect(&it->rect, &stack[stackSz - 1], &rect);
+    SDL_RenderSetClipRect(renderer, &bounds);
+    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_NONE);
+    SDL_SetRenderDrawColor(
+      renderer, background.r, background.g, background.b, background.a);
+    SDL_RenderFillRect(renderer, &bounds);
+    ++stats.drawCalls;
+    sdlBackend.begin();
+    renderItems(sdlBackend, &bounds);
+    sdlBackend.end();
+  }
+  SDL_RenderSetClipRect(renderer, nullptr);
+  SDL_SetRenderTarget(renderer, target);
+
+  SDL_RenderCopy(renderer, canvas, nullptr, &canvasRect);
+  stats.drawCalls += sdlBackend.getDrawCalls() - drawCalls + 1;
+  SDL_SetRenderDrawBlendMode(renderer, blendMode);
+}
+
+inline void
+DisplayList::addDamage(SDL_Rect rect)
+{
+  if (SDL_RectEmpty(&rect)) {
+    return;
+  }
+  // Merge with anything it touches
+  for (size_t i = 0; i < damage.size();) {
+    if (SDL_HasIntersection(&damage[i], &rect)) {
+      SDL_UnionRect(&damage[i], &rect, &rect);
+      damage[i] = damage.back();
+      damage.pop_back();
+      i = 0;
+    } else {
+      ++i;
+    }
+  }
+  damage.push_back(rect);
+  if (damage.size() <= DAMAGE_MAX_COUNT) {
+    return;
+  }
+
+  // Too many areas, so merge the pair wasting less space
+  auto area = [](const SDL_Rect& r) { return Sint64(r.w) * r.h; };
+  size_t bestI = 0, bestJ = 1;
+  Sint64 bestCost = -1;
+  for (size_t i = 0; i < damage.size(); ++i) {
+    for (size_t j = i + 1; j < damage.size(); ++j) {
+      SDL_Rect merged;
+      SDL_UnionRect(&damage[i], &damage[j], &merged);
+      Sint64 cost = area(merged) - area(damage[i]) - area(damage[j]);
+      if (bestCost < 0 || cost < bestCost) {
+        bestCost = cost;
+        bestI = i;
+        bestJ = j;
       }
-      stack[stackSz++] = rect;
-      SDL_RenderSetClipRect(renderer, &rect);
-      continue;
     }
-    auto& shape = it->shape;
-    auto c = shape.color;
-    if (shape.texture == nullptr) {
-      SDL_SetRenderDrawColor(renderer, c.r, c.g, c.b, c.a);
-      SDL_RenderFillRect(renderer, &shape.rect);
+  }
+  SDL_Rect merged;
+  SDL_UnionRect(&damage[bestI], &damage[bestJ], &merged);
+  damage[bestJ] = damage.back();
+  damage.pop_back();
+  damage[bestI] = merged;
+}
+
+inline void
+DisplayList::renderItems(RenderBackend& backend, const SDL_Rect* bounds)
+{
+  // The clip is only changed when a visible item needs a different one
+  bool clipped = bounds != nullptr;
+  SDL_Rect currentClip = clipped ? *bounds : SDL_Rect{};
+  auto applyClip = [&](const SDL_Rect* clip) {
+    if (clip ? clipped && SDL_RectEquals(clip, &currentClip) : !clipped) {
+      return;
+    }
+    backend.setClip(clip);
+    ++stats.clipChanges;
+    clipped = clip != nullptr;
+    if (clip) {
+      currentClip = *clip;
+    }
+  };
+
+  visit(bounds, [&](const Command& item, const SDL_Rect* clip) {
+    if (clip) {
+      SDL_Rect rect = boundsOf(item);
+      if (!SDL_HasIntersection(&rect, clip)) {
+        return;
+      }
     }
-    SDL_SetTextureColorMod(shape.texture, c.r, c.g, c.b);
-    if (shape.srcRect.w) {
-      SDL_RenderCopy(renderer, shape.texture, &shape.srcRect, &shape.rect);
+    applyClip(clip);
+    if (item.type == TEXT) {
+      renderText(backend, item.text, clip);
     } else {
-      SDL_RenderCopy(renderer, shape.texture, nullptr, &shape.rect);
+      backend.draw(item.shape);
+      ++stats.shapes;
     }
-  }
-  SDL_SetRenderDrawBlendMode(renderer, blendMode);
-  SDL_assert(stackSz == 0);
+  });
+  applyClip(bounds);
+}
+
+inline void
+DisplayList::renderText(RenderBackend& backend,
+                        const TextRun& text,
+                        const SDL_Rect* clip)
+{
+  auto& font = text.font;
+  Shape glyph{font.texture, {}, {}, text.color};
+  int x = text.origin.x;
+  forEachCodepoint(textOf(text), [&](Uint32 codepoint) {
+    auto metrics = glyphFor(font, codepoint);
+    glyph.rect.x = x + metrics.offset.x * (1 << text.scale);
+    glyph.rect.y = text.origin.y + metrics.offset.y * (1 << text.scale);
+    glyph.rect.w = metrics.srcRect.w << text.scale;
+    glyph.rect.h = metrics.srcRect.h << text.scale;
+    // An empty srcRect would mean the whole texture, so those are skipped
+    if (metrics.srcRect.w > 0 && metrics.srcRect.h > 0 &&
+        (!clip || SDL_HasIntersection(&glyph.rect, clip))) {
+      glyph.srcRect = metrics.srcRect;
+      backend.draw(glyph);
+      ++stats.shapes;
+    }
+    x += metrics.advance << text.scale;
+  });
 }
 
 } // namespace dui
@@ -13,14 +13,15 @@ namespace dui {
 
 /// Compute element size based on its style
 inline SDL_Point
-computeSize(std::string_view str,
+computeSize(Target target,
+            std::string_view str,
             const ElementStyle& style,
             const SDL_Point& sz)
 {
   if (sz.x != 0 && sz.y != 0) {
     return sz;
   }
-  auto clientSz = measure(str, style.font, style.scale);
+  auto clientSz = measure(target, str, style.font, style.scale);
   auto elementSz = elementSize(style.padding + style.border, clientSz);
   if (sz.x != 0) {
     elementSz.x = sz.x;
@@ -46,7 +47,7 @@ element(Target target,
         const ElementStyle& style = themeFor<Element>())
 {
   auto offset = style.border + style.padding;
-  auto sz = computeSize(str, style, {r.w, r.h});
+  auto sz = computeSize(target, str, style, {r.w, r.h});
   auto g = group(target, {}, {r.x, r.y, sz.x, sz.y}, Layout::NONE);
   text(g, str, {offset.left, offset.top}, style);
   box(g, {0, 0, sz.x, sz.y}, style);
@@ -1,28 +1,223 @@
 #ifndef DUI_FONT_HPP
 #define DUI_FONT_HPP
 
+#include <string_view>
+#include <unordered_map>
 #include <SDL.h>
+#include "Utf8.hpp"
 
 namespace dui {
 
+/// Where a glyph is on the font texture and how far it moves the next one
+struct Glyph
+{
+  SDL_Rect srcRect;
+  int advance;
+  SDL_Point offset{0, 0}; ///< From the pen position to the srcRect corner
+};
+
+/**
+ * @brief Glyph metrics by code point
+ *
+ * Latin-1 code points are on a table and the others on a hash map, so any
+ * script can be covered without slowing down the common case.
+ */
+class GlyphMap
+{
+  Glyph latin1[256]{};
+  std::unordered_map<Uint32, Glyph> others;
+
+public:
+  Glyph fallback{};       ///< Used for code points not on the map
+  int uniformAdvance = 0; ///< If not 0, the advance of all glyphs
+
+  /// The glyph for codepoint, or fallback if it has none
+  const Glyph& get(Uint32 codepoint) const
+  {
+    if (codepoint < 256) {
+      return latin1[codepoint];
+    }
+    auto it = others.find(codepoint);
+    return it != others.end() ? it->second : fallback;
+  }
+
+  /// True if codepoint has its own glyph. Latin-1 ones always have
+  bool contains(Uint32 codepoint) const
+  {
+    return codepoint < 256 || others.count(codepoint) > 0;
+  }
+
+  /// The glyph for codepoint, added if needed
+  Glyph& operator[](Uint32 codepoint)
+  {
+    return codepoint < 256 ? latin1[codepoint] : others[codepoint];
+  }
+
+  /// A copy with all metrics multiplied by 2^scale, for a scaled texture
+  GlyphMap scaled(int scale) const
+  {
+    auto scaleGlyph = [scale](Glyph g) {
+      g.srcRect = {g.srcRect.x << scale,
+                   g.srcRect.y << scale,
+                   g.srcRect.w << scale,
+                   g.srcRect.h << scale};
+      g.advance <<= scale;
+      g.offset = {g.offset.x * (1 << scale), g.offset.y * (1 << scale)};
+      return g;
+    };
+    GlyphMap result;
+    for (int i = 0; i < 256; ++i) {
+      result.latin1[i] = scaleGlyph(latin1[i]);
+    }
+    for (auto& [codepoint, glyph] : others) {
+      result.others.emplace(codepoint, scaleGlyph(glyph));
+    }
+    result.fallback = scaleGlyph(fallback);
+    result.uniformAdvance = uniformAdvance << scale;
+    return result;
+  }
+};
+
+/// Glyphs loaded on demand, see TrueTypeFont
+class GlyphCache
+{
+public:
+  virtual ~GlyphCache() = default;
+
+  /**
+   * @brief Add the metrics of the glyphs of text to the map, if missing
+   *
+   * Their srcRect stay empty until loaded.
+   */
+  virtual void addMetrics(std::string_view text) = 0;
+
+  /**
+   * @brief Make the glyphs of text ready to be rendered
+   *
+   * Their metrics must not change until it is called with a different frame.
+   *
+   * @param text the text
+   * @param frame a number identifying the current frame
+   */
+  virtual void load(std::string_view text, Uint32 frame) = 0;
+};
+
+/**
+ * @brief A bitmap font
+ *
+ * Glyphs are either all charW x charH cells on a grid with cols columns,
+ * indexed by Latin-1 code point (monospace), or described by a GlyphMap that
+ * must outlive the font. In both cases charH is the line height.
+ *
+ * If it has a cache, the glyphs srcRect are only valid after loading them.
+ */
 struct Font
 {
   SDL_Texture* texture;
   int charW, charH;
   int cols;
+  const GlyphMap* glyphs = nullptr; ///< Glyph metrics, nullptr if monospace
+  GlyphCache* cache = nullptr;      ///< Loads glyphs on demand, if not nullptr
 };
 
+/// The metrics for the given code point
+inline Glyph
+glyphFor(const Font& font, Uint32 codepoint)
+{
+  if (font.glyphs) {
+    return font.glyphs->get(codepoint);
+  }
+  if (codepoint >= 256) {
+    codepoint = '?';
+  }
+  return {
+    {int(codepoint % font.cols) * font.charW,
+     int(codepoint / font.cols) * font.charH,
+     font.charW,
+     font.charH},
+    font.charW,
+  };
+}
+
+/// True if all glyphs have the same advance, charW
+inline bool
+isMonospace(const Font& font)
+{
+  return !font.glyphs || font.glyphs->uniformAdvance == font.charW;
+}
+
+/**
+ * @brief Fill a map with a monospace font's metrics
+ *
+ * It can be used as starting point for proportional fonts with the same
+ * layout, adjusting the advance or srcRect for some glyphs (and then
+ * resetting uniformAdvance), or to map other code points to the grid.
+ */
+inline void
+fillUniformGlyphs(const Font& font, GlyphMap& glyphs)
+{
+  Font monospace{font.texture, font.charW, font.charH, font.cols};
+  for (Uint32 ch = 0; ch < 256; ++ch) {
+    glyphs[ch] = glyphFor(monospace, ch);
+  }
+  glyphs.fallback = glyphFor(monospace, '?');
+  glyphs.uniformAdvance = font.charW;
+}
+
+/// The width of the UTF-8 text, without scaling
+inline int
+textWidth(std::string_view text, const Font& font)
+{
+  if (isMonospace(font)) {
+    return font.charW * int(utf8Length(text));
+  }
+  int width = 0;
+  forEachCodepoint(
+    text, [&](Uint32 ch) { width += font.glyphs->get(ch).advance; });
+  return width;
+}
+
 #include "defaultFont.h"
 
-inline Font
-loadDefaultFont(SDL_Renderer* renderer)
+/// Load the default font bitmap, with black as the transparent color
+inline SDL_Surface*
+loadDefaultFontSurface()
 {
   SDL_RWops* src = SDL_RWFromConstMem(font_bmp, font_bmp_len);
   SDL_Surface* surface = SDL_LoadBMP_RW(src, 1);
   SDL_SetColorKey(surface, 1, 0);
+  return surface;
+}
+
+/**
+ * @brief The glyphs of the default font
+ *
+ * Only ASCII is there, the other code points use the 0x0f cell.
+ */
+inline const GlyphMap&
+defaultFontGlyphs()
+{
+  static const GlyphMap glyphs = [] {
+    Font grid{nullptr, 8, 8, 16};
+    GlyphMap glyphs;
+    fillUniformGlyphs(grid, glyphs);
+    glyphs.fallback = glyphs['\x0f'];
+    for (Uint32 ch = 0x80; ch < 256; ++ch) {
+      glyphs[ch] = glyphs.fallback;
+    }
+    return glyphs;
+  }();
+  return glyphs;
+}
+
+/// Load the default font as a texture of the given renderer
+inline Font
+loadDefaultFont(SDL_Renderer* renderer)
+{
+  SDL_Surface* surface = loadDefaultFontSurface();
   SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, surface);
   SDL_FreeSurface(surface);
-  return {texture, 8, 8, 16};
+  return {texture, 8, 8, 16, &defaultFontGlyphs()};
 }
 
 } // namespace dui
@@ -45,6 +45,33 @@ public:
     state.render();
   }
 
+  /**
+   * @brief Ends and then renders the frame into a canvas
+   *
+   * This is equivalent to call end(), followed by
+   * State.render(canvas, background).
+   */
+  void render(SDL_Texture* canvas, SDL_Color background)
+  {
+    SDL_assert(state != nullptr);
+    auto& state = *this->state;
+    end();
+    state.render(canvas, background);
+  }
+
+  /**
+   * @brief Ends and then renders the frame with the given backend
+   *
+   * This is equivalent to call end(), followed by State.render(backend).
+   */
+  void render(RenderBackend& backend)
+  {
+    SDL_assert(state != nullptr);
+    auto& state = *this->state;
+    end();
+    state.render(backend);
+  }
+
   /// Finishes the frame and unlock the state
   void end();
 
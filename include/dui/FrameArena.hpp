@@ -0,0 +1,194 @@
+#ifndef DUI_FRAME_ARENA_HPP
+#define DUI_FRAME_ARENA_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <SDL.h>
+
+namespace dui {
+
+/**
+ * @brief Memory that lives until the end of the frame
+ *
+ * Allocating is just moving a pointer forward, and everything is released at
+ * once by reset(). When a frame needs more than the arena has, more blocks are
+ * added, and on reset() they are merged in a single one, so after a few frames
+ * there are no more heap allocations.
+ *
+ * Nothing is destroyed, so only trivially destructible objects can be created
+ * on it.
+ *
+ * The elements in this library do not allocate from it, as they need no
+ * scratch memory. It is there for custom elements, through
+ * State::frameArena().
+ */
+class FrameArena
+{
+  struct Block
+  {
+    std::unique_ptr<char[]> data;
+    size_t size;
+  };
+
+  std::vector<Block> blocks;
+  size_t current = 0;  // Block being used
+  size_t offset = 0;   // Position on the current block
+  size_t used = 0;     // Bytes allocated on previous blocks
+  size_t highest = 0;  // Largest size() on any frame
+  size_t blockSize;
+
+public:
+  /// Ctor. No memory is allocated until needed
+  explicit FrameArena(size_t blockSize = 16 << 10)
+    : blockSize(blockSize)
+  {}
+
+  FrameArena(const FrameArena&) = delete;
+  FrameArena& operator=(const FrameArena&) = delete;
+
+  /**
+   * @brief Allocate uninitialized memory
+   *
+   * @param size the size in bytes
+   * @param align the alignment, a power of 2
+   * @return the memory, valid until reset()
+   */
+  void* allocate(size_t size, size_t align = alignof(std::max_align_t));
+
+  /// Allocate an uninitialized array of count T
+  template<class T>
+  T* allocate(size_t count)
+  {
+    static_assert(std::is_trivially_destructible_v<T>);
+    return static_cast<T*>(allocate(count * sizeof(T), alignof(T)));
+  }
+
+  /// Create a T, that is never destroyed
+  template<class T, class... ARGS>
+  T* make(ARGS&&... args)
+  {
+    static_assert(std::is_trivially_destructible_v<T>);
+    return new (allocate(sizeof(T), alignof(T)))
+      T{std::forward<ARGS>(args)...};
+  }
+
+  /// Copy str, so it lives until reset()
+  std::string_view copy(std::string_view str)
+  {
+    if (str.empty()) {
+      return {};
+    }
+    char* data = allocate<char>(str.size());
+    std::memcpy(data, str.data(), str.size());
+    return {data, str.size()};
+  }
+
+  /// Release everything allocated, keeping the memory for the next frame
+  void reset();
+
+  /// Bytes allocated since the last reset()
+  size_t size() const { return used + offset; }
+
+  /// The largest size() reached, the memory the arena settles on
+  size_t highWater() const { return std::max(highest, size()); }
+
+  /// Bytes reserved from the heap
+  size_t capacity() const
+  {
+    size_t total = 0;
+    for (auto& block : blocks) {
+      total += block.size;
+    }
+    return total;
+  }
+};
+
+/**
+ * @brief Adapts FrameArena for standard containers
+ *
+ * Deallocation does nothing, the memory is only released by the arena's
+ * reset(). Containers using it must not outlive the frame.
+ */
+template<class T>
+struct FrameAllocator
+{
+  using value_type = T;
+
+  FrameArena* arena;
+
+  FrameAllocator(FrameArena& arena)
+    : arena(&arena)
+  {}
+
+  template<class U>
+  FrameAllocator(const FrameAllocator<U>& other)
+    : arena(other.arena)
+  {}
+
+  T* allocate(size_t n)
+  {
+    return static_cast<T*>(arena->allocate(n * sizeof(T), alignof(T)));
+  }
+
+  void deallocate(T*, size_t) {}
+
+  template<class U>
+  bool operator==(const FrameAllocator<U>& rhs) const
+  {
+    return arena == rhs.arena;
+  }
+
+  template<class U>
+  bool operator!=(const FrameAllocator<U>& rhs) const
+  {
+    return arena != rhs.arena;
+  }
+};
+
+inline void*
+FrameArena::allocate(size_t size, size_t align)
+{
+  SDL_assert(align > 0 && (align & (align - 1)) == 0);
+  while (current < blocks.size()) {
+    auto& block = blocks[current];
+    auto base = reinterpret_cast<uintptr_t>(block.data.get());
+    size_t start = ((base + offset + align - 1) & ~(align - 1)) - base;
+    if (start + size <= block.size) {
+      offset = start + size;
+      return block.data.get() + start;
+    }
+    // Skipped blocks count as used, so the merged one is large enough
+    used += block.size;
+    offset = 0;
+    ++current;
+  }
+  size_t newSize = std::max(blockSize, size + align);
+  blocks.push_back({std::make_unique<char[]>(newSize), newSize});
+  return allocate(size, align);
+}
+
+inline void
+FrameArena::reset()
+{
+  highest = highWater();
+  if (blocks.size() > 1) {
+    size_t total = capacity();
+    blocks.clear();
+    blocks.push_back({std::make_unique<char[]>(total), total});
+  }
+  current = 0;
+  offset = 0;
+  used = 0;
+}
+
+} // namespace dui
+
+#endif // DUI_FRAME_ARENA_HPP
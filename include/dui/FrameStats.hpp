@@ -0,0 +1,89 @@
+#ifndef DUI_FRAME_STATS_HPP
+#define DUI_FRAME_STATS_HPP
+
+#include <vector>
+#include <SDL.h>
+
+namespace dui {
+
+/// What a DisplayList render did
+struct RenderStats
+{
+  Uint32 shapes = 0;      ///< Shapes sent to the backend, glyphs included
+  Uint32 drawCalls = 0;   ///< Draw calls the backend issued
+  Uint32 clipChanges = 0; ///< Clip rect changes
+};
+
+/**
+ * @brief The cost of a frame
+ *
+ * The build counters and time are complete after the frame ends, the render
+ * ones after it is rendered.
+ */
+struct FrameStats
+{
+  Uint32 commands = 0;    ///< Display list commands
+  Uint32 groups = 0;      ///< Groups opened
+  Uint32 mouseChecks = 0; ///< Calls to State.checkMouse()
+  Uint32 arenaBytes = 0;  ///< Allocated from State.frameArena()
+  Uint32 arenaPeak = 0;   ///< Most arenaBytes on any frame, the memory kept
+  Uint32 shapes = 0;      ///< @copydoc RenderStats::shapes
+  Uint32 drawCalls = 0;   ///< @copydoc RenderStats::drawCalls
+  Uint32 clipChanges = 0; ///< @copydoc RenderStats::clipChanges
+  double buildTime = 0;   ///< Seconds from the frame start to its end
+  double renderTime = 0;  ///< Seconds spent rendering, 0 if not rendered
+};
+
+/**
+ * @brief Keeps the stats of the last frames
+ *
+ * It has a fixed capacity, after which the oldest frames are discarded.
+ */
+class FrameStatsHistory
+{
+  std::vector<FrameStats> frames;
+  size_t first = 0;
+  size_t count = 0;
+
+public:
+  /// Max number of frames kept
+  size_t capacity() const { return frames.size(); }
+
+  /// Change the capacity, discarding all frames
+  void setCapacity(size_t value)
+  {
+    frames.assign(value, {});
+    first = 0;
+    count = 0;
+  }
+
+  /// Number of frames kept
+  size_t size() const { return count; }
+
+  bool empty() const { return count == 0; }
+
+  /// Add a frame, discarding the oldest if full
+  void push(const FrameStats& stats)
+  {
+    if (frames.empty()) {
+      return;
+    }
+    if (count < frames.size()) {
+      frames[(first + count++) % frames.size()] = stats;
+      return;
+    }
+    frames[first] = stats;
+    first = (first + 1) % frames.size();
+  }
+
+  /// The i-th frame, from the oldest (0) to the newest (size() - 1)
+  const FrameStats& operator[](size_t i) const
+  {
+    SDL_assert(i < count);
+    return frames[(first + i) % frames.size()];
+  }
+};
+
+} // namespace dui
+
+#endif // DUI_FRAME_STATS_HPP
@@ -24,6 +24,7 @@ class Group : public Targetable<Group>
   SDL_Rect rect;
   SDL_Point topLeft;
   SDL_Point bottomRight;
+  SDL_Rect visible;
   GroupStyle style;
 
   static constexpr SDL_Point makeCaret(const SDL_Point& caret, int x, int y)
@@ -82,11 +83,33 @@ public:
       bottomRight,
       locked,
       style,
+      visible,
     };
   }
 
   /// Finished group and stop accepting new elements
   void end();
+
+  /**
+   * @brief Finish the group, advancing the parent by extent
+   *
+   * The group keeps its size, set with setWidth() and setHeight() if auto
+   * sized, but takes only extent on its parent's layout. Groups filling their
+   * parent use this, so they do not keep it from shrinking.
+   */
+  void end(const SDL_Point& extent);
+
+  /**
+   * @brief Set the parent, after it was moved
+   *
+   * A Target points to the group it came from, so children must be retargeted
+   * when their parent moves while they are open.
+   */
+  void retarget(Target parent)
+  {
+    SDL_assert(!ended);
+    this->parent = parent;
+  }
 };
 
 /**
@@ -157,6 +180,11 @@ inline Group::Group(Target parent,
   , rect(rect)
   , topLeft(makeCaret(parent.getCaret(), rect.x - scroll.x, rect.y - scroll.y))
   , bottomRight(topLeft)
+  , visible(clipVisible(parent.getVisible(),
+                        {parent.getCaret().x + rect.x,
+                         parent.getCaret().y + rect.y,
+                         rect.w,
+                         rect.h}))
   , style(style)
 {
   parent.lock(id, rect);
@@ -172,8 +200,15 @@ Group::end()
   if (rect.h == 0) {
     rect.h = height();
   }
+  end({rect.w, rect.h});
+}
+
+inline void
+Group::end(const SDL_Point& extent)
+{
+  SDL_assert(!ended);
   parent.unlock(id, rect);
-  parent.advance({rect.x + rect.w, rect.y + rect.h});
+  parent.advance({rect.x + extent.x, rect.y + extent.y});
   ended = true;
   parent = {};
 }
@@ -181,9 +216,13 @@ Group::end()
 inline Group::Group(Group&& rhs)
   : parent(rhs.parent)
   , id(std::move(rhs.id))
+  , locked(rhs.locked)
+  , ended(rhs.ended)
   , rect(rhs.rect)
   , topLeft(rhs.topLeft)
   , bottomRight(rhs.bottomRight)
+  , visible(rhs.visible)
+  , style(rhs.style)
 {
   rhs.ended = true;
 }
@@ -0,0 +1,93 @@
+#ifndef DUI_ID_HPP_
+#define DUI_ID_HPP_
+
+#include <string>
+#include <string_view>
+#include <SDL.h>
+
+namespace dui {
+
+constexpr char groupNameSeparator = '/';
+
+/**
+ * @brief A hashed element id, qualified by its enclosing groups
+ *
+ * The hash is the FNV-1a of the element's full path, computed incrementally
+ * for each nesting level, so comparing ids is a single integer comparison.
+ *
+ * Define DUI_DEBUG_IDS to also keep the textual path, so hash collisions are
+ * detected and logged.
+ */
+struct Id
+{
+  Uint32 hash = 0; ///< The hash, 0 means no element
+
+#ifdef DUI_DEBUG_IDS
+  std::string path; ///< The textual path
+#endif
+
+  /// FNV-1a offset basis, used as the root group id
+  static constexpr Uint32 SEED = 2166136261u;
+
+  /// The root of all groups
+  static Id root() { return {SEED}; }
+
+  /// If true this does not refer to any element
+  bool empty() const { return hash == 0; }
+
+  /// Make this refer to no element
+  void clear()
+  {
+    hash = 0;
+#ifdef DUI_DEBUG_IDS
+    path.clear();
+#endif
+  }
+};
+
+/// Hash the given id as a child of parent
+inline Id
+combineId(const Id& parent, std::string_view id)
+{
+  constexpr Uint32 PRIME = 16777619u;
+  Uint32 hash = (parent.hash ^ Uint8(groupNameSeparator)) * PRIME;
+  for (Uint8 ch : id) {
+    hash = (hash ^ ch) * PRIME;
+  }
+  if (hash == 0) {
+    hash = 1;
+  }
+#ifdef DUI_DEBUG_IDS
+  std::string path = parent.path;
+  path += groupNameSeparator;
+  path += id;
+  return {hash, std::move(path)};
+#else
+  return {hash};
+#endif
+}
+
+inline bool
+operator==(const Id& lhs, const Id& rhs)
+{
+#ifdef DUI_DEBUG_IDS
+  if (lhs.hash == rhs.hash && lhs.path != rhs.path) {
+    SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION,
+                "Id collision between \"%s\" and \"%s\"",
+                lhs.path.c_str(),
+                rhs.path.c_str());
+    return false;
+  }
+#endif
+  return lhs.hash == rhs.hash;
+}
+
+inline bool
+operator!=(const Id& lhs, const Id& rhs)
+{
+  return !(lhs == rhs);
+}
+
+} // namespace dui
+
+#endif // DUI_ID_HPP_
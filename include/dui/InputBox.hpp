@@ -1,11 +1,13 @@
 #ifndef DUI_INPUTBOX_HPP
 #define DUI_INPUTBOX_HPP
 
+#include <algorithm>
 #include <string_view>
 #include "Element.hpp"
 #include "Group.hpp"
 #include "InputBoxStyle.hpp"
 #include "Panel.hpp"
+#include "Utf8.hpp"
 
 namespace dui {
 
@@ -47,10 +49,17 @@ makeInputRect(SDL_Rect r, const InputBoxStyle& style)
 struct TextChange
 {
   std::string_view insert; ///< Text to be inserted
-  size_t index;            ///< start position
+  size_t index;            ///< start position, in bytes
   size_t erase;            ///< number of bytes to dele before inserting
 };
 
+/// The cursor of a text box, kept on State while it is active
+struct TextBoxCursor
+{
+  size_t pos = 0; ///< The cursor position, in code points
+  size_t max = 0; ///< The text length, in code points
+};
+
 /// Base for input boxes
 inline TextChange
 textBoxBase(Target target,
@@ -59,17 +68,21 @@ textBoxBase(Target target,
             SDL_Rect r,
             const InputBoxStyle& style = themeFor<InputBoxBase>())
 {
-  static size_t cursorPos = 0;
-  static size_t maxPos = 0;
   r = makeInputRect(r, style);
-  if (target.checkMouse(id, r) == MouseAction::GRAB) {
-    maxPos = cursorPos = value.size();
-  }
-
+  bool grabbed = target.checkMouse(id, r) == MouseAction::GRAB;
   auto action = target.checkText(id);
   bool active = action == TextAction::NONE ? target.isActive(id) : true;
-  if (active && cursorPos > value.size()) {
-    maxPos = cursorPos = value.size();
+
+  // Inactive boxes have no cursor, so they keep nothing on State
+  TextBoxCursor unused;
+  auto& cursor = active ? target.storage<TextBoxCursor>(id) : unused;
+  size_t cursorOffset = 0;
+  if (active) {
+    auto length = utf8Length(value);
+    if (grabbed || cursor.pos > length) {
+      cursor.max = cursor.pos = length;
+    }
+    cursorOffset = utf8Offset(value, cursor.pos);
   }
   auto& currentColors = active ? style.active : style.normal;
   auto g = panel(
@@ -77,51 +90,60 @@ textBoxBase(Target target,
 
   // This creates an auto scroll effect if value text don't fit in the box;
   auto clientSz = clientSize(style.padding + EdgeSize::all(1), {r.w, r.h});
-  auto contentSz = measure(value, style.font, style.scale);
+  auto contentSz = measure(target, value, style.font, style.scale);
+  auto measureTo = [&](size_t offset) {
+    return measure(target, value.substr(0, offset), style.font, style.scale).x;
+  };
+  int cursorX = active ? measureTo(cursorOffset) : 0;
   int deltaX = contentSz.x - clientSz.x;
   if (deltaX < 0) {
     deltaX = 0;
-  } else if (active && deltaX + 8 > int(cursorPos) * 8) {
+  } else if (active) {
+    // Keep the character before the cursor visible
     // TODO Use proper scrolling here
-    deltaX = cursorPos * 8;
-    if (deltaX > 8) {
-      deltaX -= 8;
-    } else {
-      deltaX = 0;
+    int prevX = 0;
+    if (cursor.pos > 0) {
+      prevX = measureTo(utf8Offset(value, cursor.pos - 1));
     }
+    deltaX = std::min(deltaX, prevX);
   }
   text(g, value, {-deltaX, 0}, {style.font, currentColors.text, style.scale});
 
-  if (active && (target.getState().ticks() / 512) % 2) {
-    // Show cursor
-    colorBox(
-      g, {int(cursorPos) * 8 - deltaX, 0, 1, clientSz.y}, currentColors.text);
+  if (active) {
+    auto& state = target.getState();
+    auto ticks = state.ticks();
+    if ((ticks / 512) % 2) {
+      // Show cursor
+      colorBox(g, {cursorX - deltaX, 0, 1, clientSz.y}, currentColors.text);
+    }
+    state.requestFrameAt((ticks / 512 + 1) * 512);
   }
   if (action == TextAction::INPUT) {
     auto insert = target.lastText();
-    auto index = cursorPos;
-    cursorPos += insert.size();
-    maxPos += insert.size();
-    return {insert, index, 0};
+    auto length = utf8Length(insert);
+    cursor.pos += length;
+    cursor.max += length;
+    return {insert, cursorOffset, 0};
   }
   if (action == TextAction::KEYDOWN) {
     SDL_Keysym keysym = target.lastKeyDown();
     switch (keysym.sym) {
       case SDLK_BACKSPACE:
-        if (!value.empty()) {
-          cursorPos -= 1;
-          maxPos -= 1;
-          return {{}, cursorPos, 1};
+        if (cursor.pos > 0) {
+          auto index = utf8Offset(value, cursor.pos - 1);
+          cursor.pos -= 1;
+          cursor.max -= 1;
+          return {{}, index, cursorOffset - index};
         }
         break;
       case SDLK_LEFT:
-        if (cursorPos > 0) {
-          cursorPos -= 1;
+        if (cursor.pos > 0) {
+          cursor.pos -= 1;
         }
         break;
       case SDLK_RIGHT:
-        if (cursorPos < maxPos) {
-          cursorPos += 1;
+        if (cursor.pos < cursor.max) {
+          cursor.pos += 1;
         }
         break;
       default:
@@ -143,28 +165,17 @@ textBox(Target target,
 {
   auto len = strlen(value);
   auto change = textBoxBase(target, id, {value, len}, r, style);
-  if (change.erase == 0 && change.insert.empty()) {
+
+  // Insert only the whole code points that fit
+  size_t room = maxSize - 1 - (len - change.erase);
+  auto insert = change.insert.substr(0, utf8Truncate(change.insert, room));
+  if (change.erase == 0 && insert.empty()) {
     return false;
   }
-  int offset = int(change.insert.size()) - int(change.erase);
-  if (offset != 0) {
-    size_t target = change.index + change.insert.size();
-    int maxCount = maxSize - target;
-    if (maxCount > 0) {
-      size_t source = target - offset;
-      SDL_memmove(&value[target],
-                  &value[source],
-                  std::min(len - source + 1, size_t(maxCount)));
-    }
-  }
-  if (!change.insert.empty()) {
-    int maxCount = maxSize - 1 - change.index;
-    if (maxCount > 0) {
-      SDL_memcpy(&value[change.index],
-                 change.insert.data(),
-                 std::min(change.insert.size(), size_t(maxCount)));
-    }
-  }
+  size_t tail = change.index + change.erase;
+  SDL_memmove(
+    &value[change.index + insert.size()], &value[tail], len - tail + 1);
+  SDL_memcpy(&value[change.index], insert.data(), insert.size());
   return true;
 }
 
@@ -242,7 +253,12 @@ public:
       textBox(target, id, buffer, BUF_SZ, rect, style);
       return false;
     }
-    static char editBuffer[BUF_SZ];
+    // The text being edited, kept on State while active
+    struct EditBuffer
+    {
+      char text[BUF_SZ];
+    };
+    auto& editBuffer = target.storage<EditBuffer>(id).text;
     if (refillBuffer) {
       SDL_strlcpy(editBuffer, buffer, BUF_SZ);
     }
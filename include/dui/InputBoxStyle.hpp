@@ -24,6 +24,7 @@ struct NumberBox;
 struct IntBox;
 struct DoubleBox;
 struct FloatBox;
+struct TextArea;
 
 namespace style {
 
@@ -63,6 +64,9 @@ struct FromTheme<DoubleBox, Theme> : FromTheme<NumberBox, Theme>
 template<class Theme>
 struct FromTheme<FloatBox, Theme> : FromTheme<NumberBox, Theme>
 {};
+template<class Theme>
+struct FromTheme<TextArea, Theme> : FromTheme<InputBoxBase, Theme>
+{};
 }
 } // namespace dui
 
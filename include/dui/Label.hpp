@@ -41,7 +41,7 @@ centeredLabel(Target target,
               SDL_Rect r,
               const ElementStyle& style = themeFor<Label>())
 {
-  auto textSz = measure(str, style.font, style.scale);
+  auto textSz = measure(target, str, style.font, style.scale);
   SDL_Point minElementSz = elementSize(style.padding + style.border, textSz);
   if (r.w == 0) {
     r.w = minElementSz.x;
@@ -60,31 +60,13 @@ public:
   /// Return a target element for this
   operator Target() & { return wrapper; }
 
+  /// The size at the end of the last frame, known before adding the content
+  SDL_Point lastSize() const { return wrapper.lastSize(); }
+
   /// return true if it can accept elements
   operator bool() const { return wrapper; }
 };
 
-/// Return the adjusted size for a given panel
-inline SDL_Point
-makePanelSize(SDL_Point defaultSize, Target target)
-{
-  if (defaultSize.x == 0 && target.getLayout() == Layout::VERTICAL) {
-    defaultSize.x = target.width();
-  }
-  if (defaultSize.y == 0 && target.getLayout() == Layout::HORIZONTAL) {
-    defaultSize.y = target.height();
-  }
-  return defaultSize;
-}
-
-/// Return the adjusted rect for a given panel
-inline SDL_Rect
-makePanelRect(const SDL_Rect& r, Target target)
-{
-  auto sz = makePanelSize({r.w, r.h}, target);
-  return {r.x, r.y, sz.x, sz.y};
-}
-
 /**
  * @brief adds a panel element
  * @ingroup groups
@@ -105,8 +87,8 @@ panel(Target target,
   return {
     target,
     id,
-    makePanelRect(r, target),
-    [style](auto t, auto r) { return group(t, "client", r, style); },
+    r,
+    [&style](auto t, auto r) { return group(t, "client", r, style); },
     style,
   };
 }
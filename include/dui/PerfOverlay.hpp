@@ -0,0 +1,103 @@
+#ifndef DUI_PERFOVERLAY_HPP_
+#define DUI_PERFOVERLAY_HPP_
+
+#include <algorithm>
+#include <SDL.h>
+#include "Box.hpp"
+#include "FrameStats.hpp"
+#include "Group.hpp"
+#include "PerfOverlayStyle.hpp"
+#include "Text.hpp"
+#include "Theme.hpp"
+
+namespace dui {
+
+/**
+ * @brief Shows the cost of the last frames
+ * @ingroup elements
+ *
+ * It draws a graph with a stacked bar per frame, build time below and render
+ * time above, with a line at the frame budget, followed by the last frame's
+ * times, shapes and draw calls.
+ *
+ * It reads State.history(), enabling it with frames entries if disabled.
+ *
+ * @param target the parent group or frame
+ * @param p the position
+ * @param frames the number of frames on the graph
+ * @param style
+ */
+inline void
+perfOverlay(Target target,
+            const SDL_Point& p = {0},
+            size_t frames = 100,
+            const PerfOverlayStyle& style = themeFor<PerfOverlay>())
+{
+  auto& state = target.getState();
+  if (state.history().capacity() == 0) {
+    state.setHistorySize(frames);
+  }
+  auto& history = state.history();
+  FrameStats last;
+  if (!history.empty()) {
+    last = history[history.size() - 1];
+  }
+
+  // Wide enough for the graph and the longest line of text
+  auto& font = style.text.font.texture ? style.text.font : state.getFont();
+  int lineHeight = font.charH << style.text.scale;
+  int graphWidth = int(frames) * style.barWidth;
+  int h = style.graphHeight;
+  SDL_Rect r{p.x,
+             p.y,
+             std::max(graphWidth, 40 * (font.charW << style.text.scale)) + 8,
+             h + 3 * lineHeight + 12};
+  auto g = group(target, {}, r, Layout::NONE);
+
+  // The display list is drawn backwards, so what comes first is on top
+  char buffer[64];
+  int y = h + 8;
+  double total = (last.buildTime + last.renderTime) * 1000;
+  SDL_snprintf(buffer,
+               sizeof(buffer),
+               "%.2fms (build %.2f render %.2f)",
+               total,
+               last.buildTime * 1000,
+               last.renderTime * 1000);
+  text(g, buffer, {4, y}, style.text);
+  SDL_snprintf(buffer,
+               sizeof(buffer),
+               "shapes %u calls %u clips %u",
+               unsigned(last.shapes),
+               unsigned(last.drawCalls),
+               unsigned(last.clipChanges));
+  text(g, buffer, {4, y + lineHeight}, style.text);
+  SDL_snprintf(buffer,
+               sizeof(buffer),
+               "commands %u groups %u arena %uK/%uK",
+               unsigned(last.commands),
+               unsigned(last.groups),
+               unsigned((last.arenaBytes + 1023) / 1024),
+               unsigned((last.arenaPeak + 1023) / 1024));
+  text(g, buffer, {4, y + 2 * lineHeight}, style.text);
+
+  // The graph, with the newest frame at the right
+  colorBox(g, {4, 4 + h / 2, graphWidth, 1}, style.budgetColor);
+  double scale = h / (2 * style.budget);
+  size_t count = std::min(frames, history.size());
+  for (size_t i = 0; i < count; ++i) {
+    auto& stats = history[history.size() - count + i];
+    int x = 4 + int(frames - count + i) * style.barWidth;
+    int buildH = std::min(int(stats.buildTime * scale), h);
+    int renderH = std::min(int(stats.renderTime * scale), h - buildH);
+    colorBox(g, {x, 4 + h - buildH, style.barWidth, buildH}, style.buildColor);
+    colorBox(g,
+             {x, 4 + h - buildH - renderH, style.barWidth, renderH},
+             style.renderColor);
+  }
+  colorBox(g, {0, 0, r.w, r.h}, style.background);
+}
+
+} // namespace dui
+
+#endif // DUI_PERFOVERLAY_HPP_
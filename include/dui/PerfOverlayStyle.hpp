@@ -0,0 +1,94 @@
+#ifndef DUI_PERFOVERLAYSTYLE_HPP_
+#define DUI_PERFOVERLAYSTYLE_HPP_
+
+#include <SDL.h>
+#include "TextStyle.hpp"
+#include "Theme.hpp"
+
+namespace dui {
+
+/// Performance overlay style
+struct PerfOverlayStyle
+{
+  TextStyle text;
+  SDL_Color background;
+  SDL_Color buildColor;  ///< Build time bars
+  SDL_Color renderColor; ///< Render time bars, over the build ones
+  SDL_Color budgetColor; ///< The budget line
+  double budget;         ///< Frame time budget in seconds, half the graph
+  int graphHeight;
+  int barWidth;
+
+  constexpr PerfOverlayStyle withText(const TextStyle& text) const
+  {
+    return {text,
+            background,
+            buildColor,
+            renderColor,
+            budgetColor,
+            budget,
+            graphHeight,
+            barWidth};
+  }
+  constexpr PerfOverlayStyle withBackground(SDL_Color background) const
+  {
+    return {text,
+            background,
+            buildColor,
+            renderColor,
+            budgetColor,
+            budget,
+            graphHeight,
+            barWidth};
+  }
+  constexpr PerfOverlayStyle withBudget(double budget) const
+  {
+    return {text,
+            background,
+            buildColor,
+            renderColor,
+            budgetColor,
+            budget,
+            graphHeight,
+            barWidth};
+  }
+  constexpr PerfOverlayStyle withGraphSize(int graphHeight, int barWidth) const
+  {
+    return {text,
+            background,
+            buildColor,
+            renderColor,
+            budgetColor,
+            budget,
+            graphHeight,
+            barWidth};
+  }
+};
+
+struct PerfOverlay;
+struct Text;
+
+namespace style {
+
+/// Default performance overlay style
+template<class Theme>
+struct FromTheme<PerfOverlay, Theme>
+{
+  constexpr static PerfOverlayStyle get()
+  {
+    return {
+      themeFor<Text, Theme>().withColor({255, 255, 255, 255}),
+      {0, 0, 0, 191},
+      {63, 159, 255, 255},
+      {255, 159, 63, 255},
+      {255, 63, 63, 255},
+      1.0 / 60,
+      64,
+      2,
+    };
+  }
+};
+} // namespace style
+} // namespace dui
+
+#endif // DUI_PERFOVERLAYSTYLE_HPP_
@@ -0,0 +1,222 @@
+#ifndef DUI_RENDER_BACKEND_HPP
+#define DUI_RENDER_BACKEND_HPP
+
+#include <iterator>
+#include <vector>
+#include <SDL_rect.h>
+#include <SDL_render.h>
+#include <SDL_version.h>
+#include "Shape.hpp"
+
+/// If true, shapes are batched and sent with SDL_RenderGeometry()
+#ifndef DUI_RENDER_GEOMETRY
+#define DUI_RENDER_GEOMETRY SDL_VERSION_ATLEAST(2, 0, 18)
+#endif
+
+namespace dui {
+
+/**
+ * @brief Draws the shapes of a DisplayList
+ *
+ * Shapes are alpha blended. Textured ones have their color modulated by the
+ * shape color, except for alpha.
+ */
+class RenderBackend
+{
+protected:
+  Uint32 drawCalls = 0; ///< To be incremented on each draw call issued
+
+public:
+  virtual ~RenderBackend() = default;
+
+  /// Number of draw calls issued so far
+  Uint32 getDrawCalls() const { return drawCalls; }
+
+  /// Called before the first shape, with no clip set
+  virtual void begin() {}
+
+  /// Restrict the next shapes to clip (nullptr to remove the restriction)
+  virtual void setClip(const SDL_Rect* clip) = 0;
+
+  /// Draw a shape
+  virtual void draw(const Shape& shape) = 0;
+
+  /// Called after the last shape
+  virtual void end() {}
+
+  /**
+   * @brief Create a texture for the shapes, with alpha blending
+   *
+   * The pixel format is SDL_PIXELFORMAT_RGBA32 and the initial content is
+   * undefined.
+   *
+   * @return the texture or nullptr if not supported or on error
+   */
+  virtual SDL_Texture* createTexture(int, int) { return nullptr; }
+
+  /// Replace the texture pixels in rect, given as RGBA32 rows of pitch bytes
+  virtual void updateTexture(SDL_Texture*, const SDL_Rect&, const void*, int)
+  {}
+
+  /// Free a texture from createTexture()
+  virtual void destroyTexture(SDL_Texture*) {}
+};
+
+/**
+ * @brief Draws on a SDL_Renderer, merging consecutive shapes when possible
+ *
+ * Shapes are merged while they share the same texture (or are all color
+ * boxes) and sent in a single draw call.
+ *
+ * If DUI_RENDER_GEOMETRY is false, each shape is drawn as soon as added.
+ */
+class SDLRenderBackend : public RenderBackend
+{
+  SDL_Renderer* renderer = nullptr;
+  SDL_BlendMode blendMode;
+#if DUI_RENDER_GEOMETRY
+  SDL_Texture* texture = nullptr;
+  SDL_FPoint texScale;
+  std::vector<SDL_Vertex> vertices;
+  std::vector<int> indices;
+#endif
+
+  void flush();
+
+public:
+  SDLRenderBackend(SDL_Renderer* renderer = nullptr)
+    : renderer(renderer)
+  {}
+
+  SDL_Renderer* getRenderer() const { return renderer; }
+  void setRenderer(SDL_Renderer* value) { renderer = value; }
+
+  void begin() final
+  {
+    SDL_GetRenderDrawBlendMode(renderer, &blendMode);
+    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+  }
+
+  void setClip(const SDL_Rect* clip) final
+  {
+    flush();
+    SDL_RenderSetClipRect(renderer, clip);
+  }
+
+  void draw(const Shape& shape) final;
+
+  void end() final
+  {
+    flush();
+    SDL_SetRenderDrawBlendMode(renderer, blendMode);
+  }
+
+  SDL_Texture* createTexture(int w, int h) final
+  {
+    SDL_Texture* texture = SDL_CreateTexture(
+      renderer, SDL_PIXELFORMAT_RGBA32, SDL_TEXTUREACCESS_STATIC, w, h);
+    if (texture) {
+      SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+    }
+    return texture;
+  }
+
+  void updateTexture(SDL_Texture* texture,
+                     const SDL_Rect& rect,
+                     const void* pixels,
+                     int pitch) final
+  {
+    SDL_UpdateTexture(texture, &rect, pixels, pitch);
+  }
+
+  void destroyTexture(SDL_Texture* texture) final
+  {
+    SDL_DestroyTexture(texture);
+  }
+};
+
+#if DUI_RENDER_GEOMETRY
+inline void
+SDLRenderBackend::draw(const Shape& shape)
+{
+  if (shape.texture != texture || vertices.empty()) {
+    flush();
+    texture = shape.texture;
+    if (texture != nullptr) {
+      int w, h;
+      SDL_QueryTexture(texture, nullptr, nullptr, &w, &h);
+      texScale = {1.f / w, 1.f / h};
+    }
+  }
+  auto& r = shape.rect;
+  float x0 = r.x, y0 = r.y, x1 = r.x + r.w, y1 = r.y + r.h;
+  float u0 = 0, v0 = 0, u1 = 1, v1 = 1;
+  SDL_Color c = shape.color;
+  if (texture != nullptr) {
+    c.a = 255; // Only the color is modulated, as in SDL_RenderCopy()
+    auto& src = shape.srcRect;
+    if (src.w) {
+      u0 = src.x * texScale.x;
+      v0 = src.y * texScale.y;
+      u1 = (src.x + src.w) * texScale.x;
+      v1 = (src.y + src.h) * texScale.y;
+    }
+  }
+  int base = vertices.size();
+  vertices.push_back({{x0, y0}, c, {u0, v0}});
+  vertices.push_back({{x1, y0}, c, {u1, v0}});
+  vertices.push_back({{x0, y1}, c, {u0, v1}});
+  vertices.push_back({{x1, y1}, c, {u1, v1}});
+
+  // The index pattern never changes, so we keep it between batches
+  if (int(indices.size()) < base / 4 * 6 + 6) {
+    int quad[] = {base, base + 1, base + 2, base + 2, base + 1, base + 3};
+    indices.insert(indices.end(), std::begin(quad), std::end(quad));
+  }
+}
+
+inline void
+SDLRenderBackend::flush()
+{
+  if (vertices.empty()) {
+    return;
+  }
+  if (texture != nullptr) {
+    SDL_SetTextureColorMod(texture, 255, 255, 255);
+  }
+  SDL_RenderGeometry(renderer,
+                     texture,
+                     vertices.data(),
+                     vertices.size(),
+                     indices.data(),
+                     vertices.size() / 4 * 6);
+  vertices.clear();
+  ++drawCalls;
+}
+#else
+inline void
+SDLRenderBackend::draw(const Shape& shape)
+{
+  auto c = shape.color;
+  ++drawCalls;
+  if (shape.texture == nullptr) {
+    SDL_SetRenderDrawColor(renderer, c.r, c.g, c.b, c.a);
+    SDL_RenderFillRect(renderer, &shape.rect);
+    return;
+  }
+  SDL_SetTextureColorMod(shape.texture, c.r, c.g, c.b);
+  if (shape.srcRect.w) {
+    SDL_RenderCopy(renderer, shape.texture, &shape.srcRect, &shape.rect);
+  } else {
+    SDL_RenderCopy(renderer, shape.texture, nullptr, &shape.rect);
+  }
+}
+
+inline void
+SDLRenderBackend::flush()
+{}
+#endif
+
+} // namespace dui
+
+#endif // DUI_RENDER_BACKEND_HPP
@@ -0,0 +1,186 @@
+#ifndef DUI_RUNTIME_THEME_HPP_
+#define DUI_RUNTIME_THEME_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <tuple>
+#include <type_traits>
+#include "BoxStyle.hpp"
+#include "ButtonStyle.hpp"
+#include "ElementStyle.hpp"
+#include "GroupStyle.hpp"
+#include "InputBoxStyle.hpp"
+#include "InputFieldStyle.hpp"
+#include "LabelStyle.hpp"
+#include "PanelStyle.hpp"
+#include "PerfOverlayStyle.hpp"
+#include "ScrollableStyle.hpp"
+#include "SliderBoxStyle.hpp"
+#include "SliderFieldStyle.hpp"
+#include "TextStyle.hpp"
+#include "Theme.hpp"
+#include "WindowStyle.hpp"
+
+namespace dui {
+
+namespace style {
+
+template<class... ELEMENTS>
+struct ElementList
+{};
+
+/// The elements with a style on RuntimeTheme
+using ThemedElements = ElementList<Box,
+                                   ButtonBase,
+                                   Button,
+                                   ToggleButton,
+                                   ChoiceButton,
+                                   Element,
+                                   Label,
+                                   Text,
+                                   Group,
+                                   InputBoxBase,
+                                   TextBox,
+                                   NumberBox,
+                                   IntBox,
+                                   DoubleBox,
+                                   FloatBox,
+                                   TextArea,
+                                   TextField,
+                                   IntField,
+                                   DoubleField,
+                                   FloatField,
+                                   PanelDecoration,
+                                   Panel,
+                                   PerfOverlay,
+                                   Scrollable,
+                                   ScrollablePanel,
+                                   SliderBoxBar,
+                                   SliderBox,
+                                   SliderField,
+                                   WindowDecoration,
+                                   Window,
+                                   ScrollableWindow>;
+
+/// The position of Element on LIST, or SIZE_MAX if not there
+template<class Element, class LIST>
+struct ElementIndex;
+
+template<class Element>
+struct ElementIndex<Element, ElementList<>>
+{
+  static constexpr size_t value = SIZE_MAX;
+};
+
+template<class Element, class FIRST, class... ELEMENTS>
+struct ElementIndex<Element, ElementList<FIRST, ELEMENTS...>>
+{
+  static constexpr size_t find()
+  {
+    if (std::is_same_v<Element, FIRST>) {
+      return 0;
+    }
+    size_t next = ElementIndex<Element, ElementList<ELEMENTS...>>::value;
+    return next == SIZE_MAX ? SIZE_MAX : next + 1;
+  }
+  static constexpr size_t value = find();
+};
+
+template<class LIST>
+struct StyleTable;
+
+template<class... ELEMENTS>
+struct StyleTable<ElementList<ELEMENTS...>>
+{
+  using Type = std::tuple<StyleFor<ELEMENTS>...>;
+
+  template<class Theme>
+  static constexpr Type make()
+  {
+    return {themeStyle<ELEMENTS, Theme>...};
+  }
+};
+
+} // namespace style
+
+/**
+ * @brief A theme chosen at runtime
+ *
+ * Holds the style of every element on style::ThemedElements, computed from a
+ * compile time theme, and optionally changed afterwards with set(). Each
+ * style is computed once, so changing one does not change the ones derived
+ * from it (changing Element does not change Button, for example).
+ *
+ * Widgets use it for their default styles only with DUI_RUNTIME_THEME
+ * defined, through State::setTheme(). Otherwise the default styles come from
+ * DUI_THEME at compile time, with no runtime cost.
+ */
+class RuntimeTheme
+{
+  using Table = style::StyleTable<style::ThemedElements>;
+
+  Table::Type styles;
+
+  template<class Element>
+  static constexpr size_t indexOf =
+    style::ElementIndex<Element, style::ThemedElements>::value;
+
+  constexpr explicit RuntimeTheme(const Table::Type& styles)
+    : styles(styles)
+  {}
+
+public:
+  /// Create with the styles from a compile time Theme
+  template<class Theme = DUI_THEME>
+  static constexpr RuntimeTheme from()
+  {
+    return RuntimeTheme{Table::make<Theme>()};
+  }
+
+  /**
+   * @brief The style of an element
+   *
+   * Elements not on style::ThemedElements have the style on DUI_THEME.
+   */
+  template<class Element>
+  constexpr const style::StyleFor<Element>& get() const
+  {
+    if constexpr (indexOf<Element> == SIZE_MAX) {
+      return style::themeStyle<Element, DUI_THEME>;
+    } else {
+      return std::get<indexOf<Element>>(styles);
+    }
+  }
+
+  /// Change the style of an element on style::ThemedElements
+  template<class Element>
+  void set(const style::StyleFor<Element>& style)
+  {
+    static_assert(indexOf<Element> != SIZE_MAX, "Element has no style here");
+    std::get<indexOf<Element>>(styles) = style;
+  }
+};
+
+/**
+ * @brief The runtime theme with the styles of a compile time Theme
+ *
+ * It is built at compile time, so switching to it costs nothing.
+ */
+template<class Theme>
+inline constexpr RuntimeTheme runtimeTheme = RuntimeTheme::from<Theme>();
+
+#ifdef DUI_RUNTIME_THEME
+template<class Element>
+inline const style::StyleFor<Element>&
+themeFor()
+{
+  if (auto theme = style::activeTheme) {
+    return theme->get<Element>();
+  }
+  return style::themeStyle<Element, DUI_THEME>;
+}
+#endif
+
+} // namespace dui
+
+#endif // DUI_RUNTIME_THEME_HPP_
@@ -26,7 +26,7 @@ public:
               id,
               r,
               evalPadding(style),
-              [=](auto t, auto r) {
+              [&](auto t, auto r) {
                 return offsetGroup(t, "client", *scrollOffset, r, style);
               })
     , scrollOffset(scrollOffset)
@@ -88,20 +88,35 @@ public:
 
   /// Returns target object
   operator Target() { return wrapper; }
+
+  /// Set the parent, after it was moved
+  void retarget(Target parent) { wrapper.retarget(parent); }
 };
 
-/// Eval the scrollable size according with parameters
+/**
+ * @brief Eval the scrollable size according with parameters
+ *
+ * An auto size across the target's layout is kept, so the wrapper fills the
+ * target as on panel(), unless there is nothing to fill yet. Any other auto
+ * size takes a default.
+ */
 inline SDL_Point
-makeScrollableSize(const SDL_Point& defaultSize, Target target)
+makeScrollableSize(SDL_Point defaultSize, Target target)
 {
-  auto size = makePanelSize(defaultSize, target);
-  if (size.x == 0) {
-    size.x = 150;
+  auto layout = target.getLayout();
+  bool fillW = defaultSize.x == 0 && layout == Layout::VERTICAL;
+  bool fillH = defaultSize.y == 0 && layout == Layout::HORIZONTAL;
+  SDL_Point fill{0, 0};
+  if (fillW || fillH) {
+    fill = makeFillSize(target);
+  }
+  if (defaultSize.x == 0 && (!fillW || fill.x == 0)) {
+    defaultSize.x = 150;
   }
-  if (size.y == 0) {
-    size.y = 80;
+  if (defaultSize.y == 0 && (!fillH || fill.y == 0)) {
+    defaultSize.y = 80;
   }
-  return size;
+  return defaultSize;
 }
 
 /// Eval the scrollable rect according with parameters
@@ -119,8 +134,8 @@ makeScrollableRect(const SDL_Rect& r, Target target)
  * @param target the parent group or frame
  * @param id the id
  * @param scrollOffset the scrolling control variable
- * @param r the relative position and the size. If size is 0 it will use a
- * default size. Notice that this is different from group() and panel() behavior
+ * @param r the relative position and the size. If w or h is 0 it fills the
+ * parent across its layout, as panel(), or else it uses a default size
  * @param layout
  * @param style
  * @return group
@@ -156,8 +171,8 @@ scrollable(Target target,
  * @param target the parent group or frame
  * @param id the id
  * @param scrollOffset the scrolling control variable
- * @param r the relative position and the size. If size is 0 it will use a
- * default size. Notice that this is different from group() and panel() behavior
+ * @param r the relative position and the size. If w or h is 0 it fills the
+ * parent across its layout, as panel(), or else it uses a default size
  * @param layout
  * @param style
  * @return group
@@ -172,7 +187,7 @@ scrollablePanel(Target target,
   return {target,
           id,
           makeScrollableRect(r, target),
-          [=](auto t, auto r) {
+          [&](auto t, auto r) {
             return scrollable(t, "client", scrollOffset, r, style);
           },
           style};
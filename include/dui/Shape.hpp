@@ -0,0 +1,45 @@
+#ifndef DUI_SHAPE_HPP
+#define DUI_SHAPE_HPP
+
+#include <SDL_rect.h>
+#include <SDL_render.h>
+
+namespace dui {
+
+struct Shape
+{
+  SDL_Texture* texture;
+  SDL_Rect rect;
+  SDL_Rect srcRect;
+  SDL_Color color;
+
+  static Shape Box(const SDL_Rect& r, SDL_Color c)
+  {
+    return {nullptr, r, {0}, c};
+  }
+  static Shape Texture(const SDL_Rect& r, SDL_Texture* texture)
+  {
+    return {texture, r, {0}, {255, 255, 255, 255}};
+  }
+  static Shape Texture(const SDL_Rect& r, SDL_Texture* texture, SDL_Color c)
+  {
+    return {texture, r, {0}, c};
+  }
+  static Shape Texture(const SDL_Rect& r,
+                       SDL_Texture* texture,
+                       SDL_Rect& srcRect)
+  {
+    return {texture, r, srcRect, {255, 255, 255, 255}};
+  }
+  static Shape Texture(const SDL_Rect& r,
+                       SDL_Texture* texture,
+                       SDL_Rect& srcRect,
+                       SDL_Color c)
+  {
+    return {texture, r, srcRect, c};
+  }
+};
+
+} // namespace dui
+
+#endif // DUI_SHAPE_HPP
@@ -19,20 +19,20 @@ sliderBoxBarCaret(Target target,
                   const BoxStyle& style = themeFor<Box>())
 {
   box(target, r, style);
-  static SDL_Point mouseOffset;
   auto action = target.checkMouse(id, r);
-  if (action == MouseAction::HOLD) {
-    return {{0, 0}};
+  if (action != MouseAction::GRAB && action != MouseAction::HOLD &&
+      action != MouseAction::DRAG) {
+    return {};
   }
+  // Where the caret was grabbed, kept on State while it is held
+  auto& mouseOffset = target.storage<SDL_Point>(id);
+  auto pos = target.lastMousePos();
   if (action == MouseAction::GRAB) {
-    auto pos = target.lastMousePos();
     mouseOffset = {pos.x - r.x, pos.y - r.y};
-    return {{0, 0}};
   }
   if (action != MouseAction::DRAG) {
-    return {};
+    return {{0, 0}};
   }
-  auto pos = target.lastMousePos();
   SDL_Point delta{pos.x - r.x - mouseOffset.x, pos.y - r.y - mouseOffset.y};
   if (delta.x > 0 ? pos.x < r.x : pos.x > r.x) {
     delta.x = 0;
@@ -64,27 +64,37 @@ sliderBoxBar(Target target,
   SDL_assert(value != nullptr);
   auto g = panel(target, id, r, Layout::NONE, style.panel);
 
-  // TODO handle min>=max
   int distance = max - min;
+  if (distance <= 0) {
+    // Nothing to slide, so the cursor takes the whole bar
+    sliderBoxBarCaret(g, "caret", {-1, -1, r.w, r.h}, style.cursor);
+    g.end();
+    if (*value == min) {
+      return false;
+    }
+    *value = min;
+    return true;
+  }
   int cursorMax;
   SDL_Rect cursorRect;
   if (orientation == HORIZONTAL) {
     int cursorW = std::max(r.w / distance, style.minCursor);
     cursorMax = r.w - cursorW;
-    int cursorPos =
-      std::clamp((*value - min) * cursorMax / distance, 0, cursorMax);
+    int cursorPos = std::clamp(
+      int((Sint64(*value) - min) * cursorMax / distance), 0, cursorMax);
     cursorRect = {cursorPos - 1, -1, cursorW, r.h};
   } else {
     int cursorH = std::max(r.h / distance, style.minCursor);
     cursorMax = r.h - cursorH;
-    int cursorPos =
-      std::clamp((*value - min) * cursorMax / distance, 0, cursorMax);
+    int cursorPos = std::clamp(
+      int((Sint64(*value) - min) * cursorMax / distance), 0, cursorMax);
     cursorRect = {-1, cursorPos - 1, r.w, cursorH};
   }
 
   if (auto result = sliderBoxBarCaret(g, "caret", cursorRect, style.cursor)) {
-    int delta = orientation == HORIZONTAL ? result->x * distance / cursorMax
-                                          : result->y * distance / cursorMax;
+    // 64 bits, as distance might be as big as a whole list of items
+    Sint64 offset = orientation == HORIZONTAL ? result->x : result->y;
+    int delta = cursorMax > 0 ? int(offset * distance / cursorMax) : 0;
     if (delta == 0) {
       return false;
     }
@@ -0,0 +1,228 @@
+#ifndef DUI_SOFT_RENDERER_HPP
+#define DUI_SOFT_RENDERER_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include <SDL.h>
+#include "Font.hpp"
+#include "RenderBackend.hpp"
+#include "Shape.hpp"
+
+namespace dui {
+
+/**
+ * @brief Renders on a RGBA buffer in memory, using only the CPU
+ *
+ * No SDL video subsystem (nor display) is needed, so it can be used to take
+ * screenshots on servers or for deterministic tests. Results are meant to
+ * match the SDL software renderer, without filtering.
+ *
+ * The textures used by the shapes must be created with addTexture(), and the
+ * handles it returns are only meaningful for this renderer.
+ */
+class SoftRenderer : public RenderBackend
+{
+  struct Texture
+  {
+    int w, h;
+    std::vector<SDL_Color> pixels;
+  };
+
+  int width;
+  int height;
+  std::vector<SDL_Color> pixels;
+  std::vector<Texture> textures;
+  SDL_Rect clip;
+
+  static void blend(SDL_Color& dst, SDL_Color src)
+  {
+    if (src.a == 255) {
+      dst = src;
+      return;
+    }
+    int a = src.a, ia = 255 - a;
+    dst.r = (src.r * a + dst.r * ia) / 255;
+    dst.g = (src.g * a + dst.g * ia) / 255;
+    dst.b = (src.b * a + dst.b * ia) / 255;
+    dst.a = a + dst.a * ia / 255;
+  }
+
+public:
+  /// Create a renderer with a buffer of the given size, cleared to black
+  SoftRenderer(int width, int height)
+    : width(width)
+    , height(height)
+    , pixels(width * height, SDL_Color{0, 0, 0, 255})
+    , clip{0, 0, width, height}
+  {}
+
+  int getWidth() const { return width; }
+  int getHeight() const { return height; }
+
+  /**
+   * @brief The pixels, row by row
+   *
+   * The memory layout is SDL_PIXELFORMAT_RGBA32, with a pitch of width * 4,
+   * so it can be wrapped by SDL_CreateRGBSurfaceWithFormatFrom().
+   */
+  const SDL_Color* getPixels() const { return pixels.data(); }
+
+  /// The color at the given position
+  SDL_Color getPixel(int x, int y) const
+  {
+    SDL_assert(x >= 0 && x < width && y >= 0 && y < height);
+    return pixels[y * width + x];
+  }
+
+  /// Fill the whole buffer with color, ignoring the clip
+  void clear(SDL_Color color)
+  {
+    std::fill(pixels.begin(), pixels.end(), color);
+  }
+
+  /**
+   * @brief Create a texture from a surface
+   *
+   * The surface is copied, so it can be freed afterwards. Its color key, if
+   * any, is converted to transparency.
+   *
+   * @return the texture handle, to be used on Shapes and Fonts, or nullptr on
+   * error.
+   */
+  SDL_Texture* addTexture(SDL_Surface* surface);
+
+  SDL_Texture* createTexture(int w, int h) final
+  {
+    textures.push_back({w, h, std::vector<SDL_Color>(w * h)});
+    return reinterpret_cast<SDL_Texture*>(uintptr_t(textures.size()));
+  }
+
+  void updateTexture(SDL_Texture* texture,
+                     const SDL_Rect& rect,
+                     const void* pixels,
+                     int pitch) final;
+
+  void destroyTexture(SDL_Texture* texture) final
+  {
+    // The handle is not reused, so only the pixels are freed
+    auto& t = textures[reinterpret_cast<uintptr_t>(texture) - 1];
+    t = {0, 0, {}};
+  }
+
+  void begin() final { clip = {0, 0, width, height}; }
+
+  void setClip(const SDL_Rect* value) final
+  {
+    SDL_Rect bounds{0, 0, width, height};
+    if (!value) {
+      clip = bounds;
+    } else if (!SDL_IntersectRect(value, &bounds, &clip)) {
+      clip = {0, 0, 0, 0};
+    }
+  }
+
+  void draw(const Shape& shape) final;
+};
+
+inline SDL_Texture*
+SoftRenderer::addTexture(SDL_Surface* surface)
+{
+  SDL_Surface* rgba =
+    SDL_ConvertSurfaceFormat(surface, SDL_PIXELFORMAT_RGBA32, 0);
+  if (!rgba) {
+    return nullptr;
+  }
+  Texture texture{rgba->w, rgba->h, {}};
+  texture.pixels.resize(rgba->w * rgba->h);
+  SDL_LockSurface(rgba);
+  for (int y = 0; y < rgba->h; ++y) {
+    std::memcpy(&texture.pixels[y * rgba->w],
+                static_cast<Uint8*>(rgba->pixels) + y * rgba->pitch,
+                rgba->w * sizeof(SDL_Color));
+  }
+  SDL_UnlockSurface(rgba);
+  SDL_FreeSurface(rgba);
+  textures.push_back(std::move(texture));
+
+  // Handles are 1 based indices, so nullptr still means no texture
+  return reinterpret_cast<SDL_Texture*>(uintptr_t(textures.size()));
+}
+
+inline void
+SoftRenderer::updateTexture(SDL_Texture* handle,
+                            const SDL_Rect& rect,
+                            const void* pixels,
+                            int pitch)
+{
+  auto index = reinterpret_cast<uintptr_t>(handle) - 1;
+  SDL_assert(index < textures.size());
+  auto& texture = textures[index];
+  SDL_assert(rect.x >= 0 && rect.x + rect.w <= texture.w);
+  SDL_assert(rect.y >= 0 && rect.y + rect.h <= texture.h);
+  for (int y = 0; y < rect.h; ++y) {
+    std::memcpy(&texture.pixels[(rect.y + y) * texture.w + rect.x],
+                static_cast<const Uint8*>(pixels) + y * pitch,
+                rect.w * sizeof(SDL_Color));
+  }
+}
+
+inline void
+SoftRenderer::draw(const Shape& shape)
+{
+  ++drawCalls;
+  auto& r = shape.rect;
+  SDL_Rect area;
+  if (!SDL_IntersectRect(&r, &clip, &area)) {
+    return;
+  }
+  SDL_Color c = shape.color;
+  if (shape.texture == nullptr) {
+    for (int y = area.y; y < area.y + area.h; ++y) {
+      SDL_Color* row = &pixels[y * width];
+      for (int x = area.x; x < area.x + area.w; ++x) {
+        blend(row[x], c);
+      }
+    }
+    return;
+  }
+
+  auto index = reinterpret_cast<uintptr_t>(shape.texture) - 1;
+  SDL_assert(index < textures.size());
+  auto& texture = textures[index];
+  SDL_Rect src = shape.srcRect;
+  if (!src.w) {
+    src = {0, 0, texture.w, texture.h};
+  }
+  for (int y = area.y; y < area.y + area.h; ++y) {
+    int srcY = src.y + (y - r.y) * src.h / r.h;
+    const SDL_Color* srcRow = &texture.pixels[srcY * texture.w];
+    SDL_Color* row = &pixels[y * width];
+    for (int x = area.x; x < area.x + area.w; ++x) {
+      SDL_Color texel = srcRow[src.x + (x - r.x) * src.w / r.w];
+      if (texel.a == 0) {
+        continue;
+      }
+      // Only the color is modulated, as in SDL_RenderCopy()
+      texel.r = texel.r * c.r / 255;
+      texel.g = texel.g * c.g / 255;
+      texel.b = texel.b * c.b / 255;
+      blend(row[x], texel);
+    }
+  }
+}
+
+/// Load the default font as a texture of the given SoftRenderer
+inline Font
+loadDefaultFont(SoftRenderer& renderer)
+{
+  SDL_Surface* surface = loadDefaultFontSurface();
+  SDL_Texture* texture = renderer.addTexture(surface);
+  SDL_FreeSurface(surface);
+  return {texture, 8, 8, 16, &defaultFontGlyphs()};
+}
+
+} // namespace dui
+
+#endif // DUI_SOFT_RENDERER_HPP
@@ -1,15 +1,22 @@
 #ifndef DUI_STATE_HPP_
 #define DUI_STATE_HPP_
 
+#include <algorithm>
+#include <memory>
 #include <string>
+#include <unordered_map>
+#include <vector>
 #include <SDL.h>
 #include "DisplayList.hpp"
 #include "Font.hpp"
+#include "FrameArena.hpp"
+#include "FrameStats.hpp"
+#include "Id.hpp"
+#include "RenderBackend.hpp"
+#include "Theme.hpp"
 
 namespace dui {
 
-constexpr char groupNameSeparator = '/';
-
 /**
  * @brief The mouse action and status for a element in a frame
  *
@@ -44,30 +51,214 @@ enum class TextAction
  */
 class State
 {
+public:
+  /// Default memory cap for the textures of cachedGroup(), in bytes
+  static constexpr size_t GROUP_CACHE_DEFAULT_LIMIT = 16 << 20;
+
+  /// Default number of frames a value from storage() is kept while unused
+  static constexpr Uint32 STORAGE_DEFAULT_LIFETIME = 60;
+
+private:
   bool inFrame = false;
   SDL_Renderer* renderer;
   DisplayList dList;
 
   SDL_Point mPos;
   bool mLeftPressed = false;
-  std::string eGrabbed;
+  Id eGrabbed;
   bool mHovering = false;
   bool mGrabbing = false;
+
+  // Mouse sensitive areas on this and the last frame, topmost first. Top
+  // level groups are there too, with id 0, so they hide what is below them
+  struct HitArea
+  {
+    Uint32 id;
+    SDL_Rect rect;
+  };
+  std::vector<HitArea> hitAreas;
+  std::vector<HitArea> lastHitAreas;
+  Uint32 mHovered = 0; // The topmost element under the mouse on the last frame
   bool mReleasing = false;
-  std::string eActive;
+  Id eActive;
   char tBuffer[SDL_TEXTINPUTEVENT_TEXT_SIZE];
   SDL_Keysym tKeysym;
   bool tChanged = false;
   TextAction tAction = TextAction::NONE;
 
-  std::string group;
-  bool gGrabbed = false;
-  bool gActive = false;
+  Id group = Id::root();
+  std::vector<Id> groupStack;
+
+  // Sizes of the groups with id on this and the previous frame. The last
+  // ones are only sorted by id hash when first needed
+  struct GroupSize
+  {
+    Uint32 id;
+    SDL_Point size;
+
+    bool operator<(const GroupSize& rhs) const { return id < rhs.id; }
+  };
+  std::vector<GroupSize> sizes;
+  mutable std::vector<GroupSize> lastSizes;
+  mutable bool lastSizesSorted = false;
 
   Uint32 ticksCount;
+  Uint32 nextFrameTicks = 0;
+  Uint64 lastHash = 0;
+  bool dirty = true;
+  bool forceRedraw = false;
+  bool waited = false;
+
+  FrameStats frameStats;
+  FrameStatsHistory statsHistory;
+  Uint64 frameStart = 0;
+  Uint32 frameCount = 0;
+
+  // Open addressing table, so clearing it keeps its memory
+  class MeasureTable
+  {
+    struct Entry
+    {
+      Uint64 key; // 0 means empty
+      SDL_Point size;
+    };
+    std::vector<Entry> entries;
+    size_t count = 0;
+
+    size_t slot(Uint64 key) const
+    {
+      // The lowest bit is always set, so it is skipped
+      size_t mask = entries.size() - 1;
+      size_t i = (size_t(key ^ key >> 32) >> 1) & mask;
+      while (entries[i].key != 0 && entries[i].key != key) {
+        i = (i + 1) & mask;
+      }
+      return i;
+    }
+
+  public:
+    const SDL_Point* find(Uint64 key) const
+    {
+      if (count == 0) {
+        return nullptr;
+      }
+      auto& entry = entries[slot(key | 1)];
+      return entry.key != 0 ? &entry.size : nullptr;
+    }
+
+    void insert(Uint64 key, const SDL_Point& size);
+
+    void swap(MeasureTable& other)
+    {
+      entries.swap(other.entries);
+      std::swap(count, other.count);
+    }
+
+    void clear()
+    {
+      if (count > 0) {
+        std::fill(entries.begin(), entries.end(), Entry{0, {0, 0}});
+        count = 0;
+      }
+    }
+  };
+
+  // Text measurements of this and the previous frame, by measureKey()
+  MeasureTable measures;
+  MeasureTable lastMeasures;
+
+  FrameArena arena;
 
   Font font;
 
+  // Copies of the font textures upscaled with nearest neighbour, by atlasKey()
+  struct ScaledFont
+  {
+    Font font;
+    GlyphMap glyphs;
+  };
+  std::unordered_map<Uint64, ScaledFont> scaledFonts;
+
+  // Rendered contents of cachedGroup(), by id hash
+  struct CachedGroup
+  {
+    Uint64 key;
+    SDL_Point size;
+    SDL_Texture* texture = nullptr;
+    DisplayList commands; // To be rendered into texture
+    bool pending = false;
+    Uint32 lastUsed;
+  };
+  std::unordered_map<Uint32, CachedGroup> cachedGroups;
+  size_t groupCacheBytes = 0;
+  size_t groupCacheLimit = GROUP_CACHE_DEFAULT_LIMIT;
+
+  bool targetsLost = false;
+  bool fontsReleased = false; // Set by releaseFontCaches()
+
+  // Values kept by storage(), by id hash and type
+  struct StoredValue
+  {
+    virtual ~StoredValue() = default;
+  };
+  template<class T>
+  struct Stored : StoredValue
+  {
+    T value{};
+  };
+  template<class T>
+  static inline const char storageType = 0; // Its address tells the type
+  struct StorageKey
+  {
+    Uint32 id;
+    const void* type;
+
+    bool operator==(const StorageKey& rhs) const
+    {
+      return id == rhs.id && type == rhs.type;
+    }
+  };
+  struct StorageKeyHash
+  {
+    size_t operator()(const StorageKey& key) const
+    {
+      return std::hash<const void*>{}(key.type) ^ key.id;
+    }
+  };
+  struct StorageEntry
+  {
+    std::unique_ptr<StoredValue> stored;
+    Uint32 lastUsed;
+  };
+  std::unordered_map<StorageKey, StorageEntry, StorageKeyHash> storages;
+  Uint32 storageLifetime = STORAGE_DEFAULT_LIFETIME;
+
+  const RuntimeTheme* theme = nullptr;
+  const RuntimeTheme* outerTheme = nullptr; // activeTheme before beginFrame()
+
+  static Uint64 atlasKey(const Font& font, int scale)
+  {
+    Uint64 h = 14695981039346656037ull;
+    auto mix = [&](Uint64 v) { h = (h ^ v) * 1099511628211ull; };
+    mix(Uint64(uintptr_t(font.texture)));
+    mix(Uint64(uintptr_t(font.glyphs)));
+    mix(Uint64(Uint32(font.charW)) << 32 | Uint32(scale));
+    return h;
+  }
+
+  static Uint64 measureKey(std::string_view str, const Font& font, int scale)
+  {
+    Uint64 h = 14695981039346656037ull;
+    auto mix = [&](Uint64 v) { h = (h ^ v) * 1099511628211ull; };
+    mix(Uint64(uintptr_t(font.texture)));
+    mix(Uint64(uintptr_t(font.glyphs)));
+    mix(Uint64(Uint32(font.charH)) << 32 | Uint32(scale));
+    for (Uint8 ch : str) {
+      mix(ch);
+    }
+    return h;
+  }
+
 public:
   /// Ctor
   State(SDL_Renderer* renderer)
@@ -75,6 +266,29 @@ public:
     , font(loadDefaultFont(renderer))
   {}
 
+  /**
+   * @brief Create a state without renderer
+   *
+   * It can only be rendered with render(RenderBackend&).
+   *
+   * @param font the font, with a texture valid for the backend
+   * @see SoftRenderer
+   */
+  State(const Font& font)
+    : renderer(nullptr)
+    , font(font)
+  {}
+
+  State(const State&) = delete;
+  State& operator=(const State&) = delete;
+
+  /// Dtor. It must run before the renderer is destroyed
+  ~State()
+  {
+    clearScaledFonts();
+    clearCachedGroups();
+  }
+
   /**
    * @brief Render the ui
    *
@@ -84,10 +298,89 @@ public:
    */
   void render()
   {
-    SDL_assert(!inFrame);
+    SDL_assert(!inFrame && renderer != nullptr);
+    Uint64 start = SDL_GetPerformanceCounter();
+    renderCachedGroups();
     dList.render(renderer);
+    updateRenderStats(start);
   }
 
+  /**
+   * @brief Render the ui with the given backend
+   *
+   * @param backend the backend
+   */
+  void render(RenderBackend& backend)
+  {
+    SDL_assert(!inFrame);
+    Uint64 start = SDL_GetPerformanceCounter();
+    renderCachedGroups();
+    dList.render(backend);
+    updateRenderStats(start);
+  }
+
+  /**
+   * @brief Render the ui, redrawing only the areas that changed
+   *
+   * The ui is kept on canvas, a texture created with
+   * SDL_TEXTUREACCESS_TARGET, and copied to the current render target.
+   *
+   * @param canvas the texture keeping the ui between frames
+   * @param background the color behind the ui
+   * @see DisplayList::render()
+   */
+  void render(SDL_Texture* canvas, SDL_Color background)
+  {
+    SDL_assert(!inFrame && renderer != nullptr);
+    Uint64 start = SDL_GetPerformanceCounter();
+    renderCachedGroups();
+    dList.render(renderer, canvas, background);
+    updateRenderStats(start);
+  }
+
+  /// The number of commands the last frame generated
+  size_t displayListSize() const { return dList.size(); }
+
+  /// The stats of the current, or last, frame
+  const FrameStats& stats() const { return frameStats; }
+
+  /// The stats of the previous frames, empty unless enabled
+  const FrameStatsHistory& history() const { return statsHistory; }
+
+  /**
+   * @brief Keep the stats of the last frames
+   *
+   * A frame is added to the history when the next one begins, so it has both
+   * build and render stats.
+   *
+   * @param frames the number of frames to keep, 0 to disable
+   */
+  void setHistorySize(size_t frames) { statsHistory.setCapacity(frames); }
+
+  /**
+   * @brief Memory released when the next frame begins
+   *
+   * For scratch data that only needs to live while the frame is built, like
+   * formatted text for labels. Its memory is kept between frames, so once it
+   * settles allocating from it does not touch the heap.
+   */
+  FrameArena& frameArena() { return arena; }
+
+  /**
+   * @brief Set the theme for the default styles
+   *
+   * Only used with DUI_RUNTIME_THEME defined. It takes effect when the next
+   * frame begins, only on the thread building it, and must outlive the frames
+   * using it.
+   *
+   * @param value the theme, or nullptr to use DUI_THEME
+   * @see runtimeTheme
+   */
+  void setTheme(const RuntimeTheme* value) { theme = value; }
+
+  /// The theme for the default styles, nullptr if DUI_THEME
+  const RuntimeTheme* getTheme() const { return theme; }
+
   /**
    * @brief Handle a SDL_Event
    *
@@ -95,6 +388,56 @@ public:
    */
   void event(SDL_Event& ev);
 
+  /**
+   * @brief Wait for the next event, if there is nothing new to show
+   *
+   * This can replace SDL_PollEvent() on the event loop. If the last frame
+   * displayed exactly the same than the frame before it and no element asked
+   * for a new frame, the first call after it blocks until an event arrives or
+   * the time requested by requestFrameAt() is reached. Otherwise, and on any
+   * subsequent call, it behaves just like SDL_PollEvent().
+   *
+   * @param ev the event to be filled
+   * @return true if an event was received
+   * @return false if there are no more events for now
+   */
+  bool waitEvent(SDL_Event* ev);
+
+  /**
+   * @brief If the last frame is different from the one before it
+   *
+   * It is safe to skip rendering (and presenting) while this is false, as the
+   * screen would look exactly the same.
+   *
+   * @return true
+   * @return false
+   */
+  bool isDirty() const { return dirty; }
+
+  /**
+   * @brief If some element asked for a new frame in a given time
+   *
+   * @return true
+   * @return false
+   */
+  bool isAnimating() const { return nextFrameTicks != 0; }
+
+  /**
+   * @brief Ask for a new frame no later than the given ticks
+   *
+   * Elements that change over time, as a blinking cursor, must call this on
+   * every frame they are visible, otherwise waitEvent() might not return until
+   * the next input.
+   *
+   * @param ticks the SDL_GetTicks() value when the frame is due
+   */
+  void requestFrameAt(Uint32 ticks)
+  {
+    if (nextFrameTicks == 0 || SDL_TICKS_PASSED(nextFrameTicks, ticks)) {
+      nextFrameTicks = ticks;
+    }
+  }
+
   /**
    * @brief If a frame is in progress
    *
@@ -117,14 +460,15 @@ public:
    * @return true
    * @return false
    */
-  bool isActive(std::string_view id) const
-  {
-    return isSameGroupId(eActive, id);
-  }
+  bool isActive(std::string_view id) const { return eActive == idFor(id); }
 
   /**
    * @brief Check the mouse action/status for element in this frame
    *
+   * Only the topmost element under the mouse can be grabbed. It is found
+   * once per frame from the areas checked on the last one, so the areas here
+   * are only compared when the element is already grabbed.
+   *
    * @param id element id
    * @param r the element global rect (Use Group.checkMouse() for local rect)
    * @return MouseAction
@@ -139,7 +483,7 @@ public:
    */
   TextAction checkText(std::string_view id) const
   {
-    if (!tChanged || !isSameGroupId(eActive, id)) {
+    if (!tChanged || eActive != idFor(id)) {
       return TextAction::NONE;
     }
     return tAction;
@@ -191,29 +535,370 @@ public:
    */
   void display(const Shape& item) { dList.insert(item); }
 
+  /**
+   * @brief Add the given text to display list
+   *
+   * @param str the text
+   * @param p the global position
+   * @param font the font
+   * @param scale the scale
+   * @param color the color
+   */
+  void display(std::string_view str,
+               const SDL_Point& p,
+               const Font& font,
+               int scale,
+               SDL_Color color)
+  {
+    display(str, p, font, scale, color, measure(str, font, scale).x);
+  }
+
+  /**
+   * @brief Add the given text to display list, already measured
+   *
+   * @param str the text
+   * @param p the global position
+   * @param font the font
+   * @param scale the scale
+   * @param color the color
+   * @param width the width measure() gave for str, font and scale
+   */
+  void display(std::string_view str,
+               const SDL_Point& p,
+               const Font& font,
+               int scale,
+               SDL_Color color,
+               int width)
+  {
+    if (font.cache) {
+      font.cache->load(str, frameCount);
+    } else if (scale > 0) {
+      if (auto scaled = scaledFont(font, scale)) {
+        dList.insertText(str, p, *scaled, 0, color, width);
+        return;
+      }
+    }
+    dList.insertText(str, p, font, scale, color, width);
+  }
+
   /// Ticks count
   Uint32 ticks() const { return ticksCount; }
 
+  /// The qualified id for an element in the current group
+  Id idFor(std::string_view id) const { return combineId(group, id); }
+
+  /**
+   * @brief The size an element of the current group had on the last frame
+   *
+   * Only groups with an id are remembered, so their layout can be known
+   * before their content is added.
+   *
+   * @param id the element id
+   * @return the size, or {0, 0} if unknown
+   */
+  SDL_Point lastSize(std::string_view id) const { return lastSize(idFor(id)); }
+
+  /// The size the element with the qualified id had on the last frame
+  SDL_Point lastSize(const Id& id) const;
+
+  /// The size the current group had on the last frame, or {0, 0} if unknown
+  SDL_Point lastGroupSize() const { return lastSize(group); }
+
+  /**
+   * @brief Persistent storage for an element of the current group
+   *
+   * Each id has a separate value for each type T, value initialized on the
+   * first call. A value not asked for during getStorageLifetime() frames is
+   * destroyed, so elements should only ask for it while they need it, like
+   * while they are active.
+   *
+   * @param id the element id
+   * @return the value, valid at least until the end of the frame
+   */
+  template<class T>
+  T& storage(std::string_view id)
+  {
+    return storage<T>(idFor(id));
+  }
+
+  /// Persistent storage for the element with the qualified id
+  template<class T>
+  T& storage(const Id& id);
+
+  /// The number of values kept by storage()
+  size_t storageSize() const { return storages.size(); }
+
+  /// The number of frames a value from storage() is kept while unused
+  Uint32 getStorageLifetime() const { return storageLifetime; }
+
+  /**
+   * @brief Set the number of frames a value from storage() is kept unused
+   *
+   * @param frames the number of frames, at least 1
+   */
+  void setStorageLifetime(Uint32 frames)
+  {
+    SDL_assert(frames > 0);
+    storageLifetime = frames;
+  }
+
   // These are experimental and should not be used
   void beginGroup(std::string_view id, const SDL_Rect& r);
   void endGroup(std::string_view id, const SDL_Rect& r);
   const Font& getFont() const { return font; }
+
+  /// Set the default font. @see releaseFontCaches() to replace a destroyed one
   void setFont(const Font& f) { font = f; }
 
+  /**
+   * @brief Measure the given text
+   *
+   * Measures of fonts with glyph metrics are cached while the same text is
+   * measured on consecutive frames. Monospace ones are cheap enough to be
+   * computed every time.
+   *
+   * @param str the text
+   * @param font the font
+   * @param scale the scale
+   * @return the size
+   */
+  SDL_Point measure(std::string_view str, const Font& font, int scale);
+
+  /**
+   * @brief The font upscaled by 2^scale, so its glyphs are copied 1:1
+   *
+   * The atlas is built on the first call for each font and scale, with nearest
+   * neighbour sampling. Fonts with a cache, whose texture changes, are not
+   * supported.
+   *
+   * Atlases are found by the addresses of the font texture and glyph map, so
+   * after destroying a font drawn scaled, call releaseFontCaches() before its
+   * addresses can be reused by another font.
+   *
+   * @return the scaled font, valid until the state is destroyed, the render
+   * targets are reset or releaseFontCaches() takes effect, or nullptr if there
+   * is no renderer or it can not render to textures
+   */
+  const Font* scaledFont(const Font& font, int scale);
+
+  /**
+   * @brief Drop everything kept for the fonts used so far
+   *
+   * The upscaled atlases of scaledFont() and the text measures are found by
+   * the addresses of the font texture and glyph map. Call this after
+   * destroying or changing a font that was used, as a font loaded later
+   * could have the same addresses and get stale atlases or measures.
+   *
+   * It takes effect when the next frame begins, so the last frame can still
+   * be rendered.
+   */
+  void releaseFontCaches() { fontsReleased = true; }
+
+  /**
+   * @brief The texture of a cached group, if it is up to date
+   *
+   * @param id the group id, on the current group
+   * @param key the content key it was cached with
+   * @param size the group size, set if found
+   * @return the texture or nullptr if there is none for this key
+   * @see cachedGroup()
+   */
+  SDL_Texture* findCachedGroup(std::string_view id,
+                               Uint64 key,
+                               SDL_Point* size);
+
+  /**
+   * @brief Cache the commands displayed since first as a group texture
+   *
+   * A key must be seen on two consecutive calls before its content is
+   * cached, so content changing every frame is never rendered twice. The
+   * texture is rendered on the next render() and the least recently used
+   * ones are freed to stay under the limit. Nothing is cached without a
+   * renderer.
+   *
+   * @param id the group id, on the current group
+   * @param key the content key
+   * @param first the displayListSize() before the group
+   * @param rect the global group rect
+   */
+  void cacheGroup(std::string_view id,
+                  Uint64 key,
+                  size_t first,
+                  const SDL_Rect& rect);
+
+  /// A hash of the commands displayed since first, relative to origin
+  Uint64 displayHash(size_t first, const SDL_Point& origin) const
+  {
+    return dList.hash(first, {-origin.x, -origin.y});
+  }
+
+  /// Remove the commands displayed since first
+  void undisplay(size_t first) { dList.truncate(first); }
+
+  /// Memory used by the textures of cached groups, in bytes
+  size_t groupCacheSize() const { return groupCacheBytes; }
+
+  /**
+   * @brief Set the memory cap for the textures of cached groups, in bytes
+   *
+   * Textures shown in the current frame are only freed on the next one.
+   */
+  void setGroupCacheLimit(size_t bytes)
+  {
+    groupCacheLimit = bytes;
+    while (groupCacheBytes > groupCacheLimit && evictCachedGroup()) {
+    }
+  }
+
 private:
+  // Find what is under the mouse, using the areas of the last frame
+  void updateHovered()
+  {
+    lastHitAreas.swap(hitAreas);
+    hitAreas.clear();
+    mHovered = 0;
+    mHovering = false;
+    for (auto& area : lastHitAreas) {
+      if (SDL_PointInRect(&mPos, &area.rect)) {
+        mHovered = area.id;
+        mHovering = true;
+        break;
+      }
+    }
+  }
+
+  void releaseCachedGroup(Uint32 id)
+  {
+    auto it = cachedGroups.find(id);
+    if (it == cachedGroups.end()) {
+      return;
+    }
+    auto& entry = it->second;
+    if (entry.texture) {
+      SDL_DestroyTexture(entry.texture);
+    }
+    if (entry.texture || entry.pending) {
+      groupCacheBytes -= size_t(entry.size.x) * entry.size.y * 4;
+    }
+    cachedGroups.erase(it);
+  }
+
+  // Free the least recently used group not used in this frame
+  bool evictCachedGroup()
+  {
+    auto lru = cachedGroups.end();
+    for (auto it = cachedGroups.begin(); it != cachedGroups.end(); ++it) {
+      if (it->second.lastUsed != frameCount &&
+          (lru == cachedGroups.end() ||
+           it->second.lastUsed < lru->second.lastUsed)) {
+        lru = it;
+      }
+    }
+    if (lru == cachedGroups.end()) {
+      return false;
+    }
+    releaseCachedGroup(lru->first);
+    return true;
+  }
+
+  void clearCachedGroups()
+  {
+    for (auto& [id, entry] : cachedGroups) {
+      if (entry.texture) {
+        SDL_DestroyTexture(entry.texture);
+      }
+    }
+    cachedGroups.clear();
+    groupCacheBytes = 0;
+  }
+
+  void renderCachedGroups();
+
+  // Destroy the values from storage() unused for too long
+  void collectStorage()
+  {
+    for (auto it = storages.begin(); it != storages.end();) {
+      if (frameCount - it->second.lastUsed > storageLifetime) {
+        it = storages.erase(it);
+      } else {
+        ++it;
+      }
+    }
+  }
+
+  void clearScaledFonts()
+  {
+    for (auto& [key, scaled] : scaledFonts) {
+      if (scaled.font.texture) {
+        SDL_DestroyTexture(scaled.font.texture);
+      }
+    }
+    scaledFonts.clear();
+  }
+
+  void updateRenderStats(Uint64 start)
+  {
+    auto& render = dList.renderStats();
+    frameStats.shapes = render.shapes;
+    frameStats.drawCalls = render.drawCalls;
+    frameStats.clipChanges = render.clipChanges;
+    frameStats.renderTime = double(SDL_GetPerformanceCounter() - start) /
+                            SDL_GetPerformanceFrequency();
+  }
+
   void beginFrame()
   {
     SDL_assert(inFrame == false);
+    if (frameStart != 0) {
+      statsHistory.push(frameStats);
+      frameStats = {};
+    }
+    frameStart = SDL_GetPerformanceCounter();
+    ++frameCount;
     inFrame = true;
+    outerTheme = style::activeTheme;
+    style::activeTheme = theme;
+    if (targetsLost) {
+      clearScaledFonts();
+      clearCachedGroups();
+      targetsLost = false;
+    }
+    if (fontsReleased) {
+      clearScaledFonts();
+      measures.clear();
+      lastMeasures.clear();
+      fontsReleased = false;
+    }
+    while (groupCacheBytes > groupCacheLimit && evictCachedGroup()) {
+    }
+    collectStorage();
+    lastMeasures.swap(measures);
+    measures.clear();
+    arena.reset();
+    updateHovered();
+    lastSizes.swap(sizes);
+    lastSizesSorted = false;
+    sizes.clear();
     dList.clear();
-    mHovering = false;
     ticksCount = SDL_GetTicks();
+    nextFrameTicks = 0;
+    waited = false;
   }
 
   void endFrame()
   {
     SDL_assert(inFrame == true);
     inFrame = false;
+    style::activeTheme = outerTheme;
+    frameStats.commands = dList.size();
+    frameStats.arenaBytes = arena.size();
+    frameStats.arenaPeak = arena.highWater();
+    frameStats.buildTime = double(SDL_GetPerformanceCounter() - frameStart) /
+                           SDL_GetPerformanceFrequency();
+    auto hash = dList.hash();
+    dirty = forceRedraw || hash != lastHash;
+    lastHash = hash;
+    forceRedraw = false;
     tChanged = false;
     mGrabbing = false;
     if (mReleasing) {
@@ -222,55 +907,288 @@ private:
     }
   }
 
-  bool isSameGroupId(std::string_view qualifiedId, std::string_view id) const;
-
   friend class Frame;
 };
 
-inline bool
-State::isSameGroupId(std::string_view qualifiedId, std::string_view id) const
+inline SDL_Point
+State::measure(std::string_view str, const Font& font, int scale)
+{
+  if (isMonospace(font)) {
+    return {textWidth(str, font) << scale, font.charH << scale};
+  }
+  auto key = measureKey(str, font, scale);
+  if (auto found = measures.find(key)) {
+    return *found;
+  }
+  SDL_Point sz;
+  if (auto found = lastMeasures.find(key)) {
+    sz = *found;
+  } else {
+    if (font.cache) {
+      font.cache->addMetrics(str);
+    }
+    sz = {textWidth(str, font) << scale, font.charH << scale};
+  }
+  measures.insert(key, sz);
+  return sz;
+}
+
+inline void
+State::MeasureTable::insert(Uint64 key, const SDL_Point& size)
+{
+  key |= 1;
+  if ((count + 1) * 2 > entries.size()) {
+    std::vector<Entry> old(std::max<size_t>(entries.size() * 2, 64),
+                           Entry{0, {0, 0}});
+    old.swap(entries);
+    for (auto& entry : old) {
+      if (entry.key != 0) {
+        entries[slot(entry.key)] = entry;
+      }
+    }
+  }
+  auto& entry = entries[slot(key)];
+  if (entry.key == 0) {
+    entry.key = key;
+    ++count;
+  }
+  entry.size = size;
+}
+
+inline const Font*
+State::scaledFont(const Font& font, int scale)
+{
+  if (!renderer || font.cache || scale <= 0) {
+    return nullptr;
+  }
+  auto key = atlasKey(font, scale);
+  if (auto it = scaledFonts.find(key); it != scaledFonts.end()) {
+    return it->second.font.texture ? &it->second.font : nullptr;
+  }
+  // Failures are kept too, with no texture, so they are not retried
+  auto& scaled = scaledFonts[key];
+  scaled.font = {nullptr,
+                 font.charW << scale,
+                 font.charH << scale,
+                 font.cols,
+                 font.glyphs ? &scaled.glyphs : nullptr};
+  if (font.glyphs) {
+    scaled.glyphs = font.glyphs->scaled(scale);
+  }
+#if SDL_VERSION_ATLEAST(2, 0, 12)
+  int w, h;
+  if (!SDL_RenderTargetSupported(renderer) ||
+      SDL_QueryTexture(font.texture, nullptr, nullptr, &w, &h) != 0) {
+    return nullptr;
+  }
+  SDL_Texture* texture = SDL_CreateTexture(renderer,
+                                           SDL_PIXELFORMAT_RGBA32,
+                                           SDL_TEXTUREACCESS_TARGET,
+                                           w << scale,
+                                           h << scale);
+  if (!texture) {
+    return nullptr;
+  }
+  SDL_Texture* previousTarget = SDL_GetRenderTarget(renderer);
+  SDL_BlendMode blendMode;
+  SDL_ScaleMode scaleMode;
+  Uint8 r, g, b;
+  SDL_GetTextureBlendMode(font.texture, &blendMode);
+  SDL_GetTextureScaleMode(font.texture, &scaleMode);
+  SDL_GetTextureColorMod(font.texture, &r, &g, &b);
+
+  // A plain copy, keeping the alpha as is
+  SDL_SetTextureBlendMode(font.texture, SDL_BLENDMODE_NONE);
+  SDL_SetTextureScaleMode(font.texture, SDL_ScaleModeNearest);
+  SDL_SetTextureColorMod(font.texture, 255, 255, 255);
+  bool copied = SDL_SetRenderTarget(renderer, texture) == 0 &&
+                SDL_RenderCopy(renderer, font.texture, nullptr, nullptr) == 0;
+  SDL_SetRenderTarget(renderer, previousTarget);
+  SDL_SetTextureBlendMode(font.texture, blendMode);
+  SDL_SetTextureScaleMode(font.texture, scaleMode);
+  SDL_SetTextureColorMod(font.texture, r, g, b);
+  if (!copied) {
+    SDL_DestroyTexture(texture);
+    return nullptr;
+  }
+  SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+  scaled.font.texture = texture;
+  return &scaled.font;
+#else
+  return nullptr;
+#endif
+}
+
+inline SDL_Point
+State::lastSize(const Id& id) const
+{
+  if (!lastSizesSorted) {
+    std::sort(lastSizes.begin(), lastSizes.end());
+    lastSizesSorted = true;
+  }
+  auto it = std::lower_bound(
+    lastSizes.begin(), lastSizes.end(), GroupSize{id.hash, {0, 0}});
+  if (it == lastSizes.end() || it->id != id.hash) {
+    return {0, 0};
+  }
+  return it->size;
+}
+
+template<class T>
+inline T&
+State::storage(const Id& id)
+{
+  auto& entry = storages[{id.hash, &storageType<T>}];
+  if (!entry.stored) {
+    entry.stored = std::make_unique<Stored<T>>();
+  }
+  entry.lastUsed = frameCount;
+  return static_cast<Stored<T>&>(*entry.stored).value;
+}
+
+inline SDL_Texture*
+State::findCachedGroup(std::string_view id, Uint64 key, SDL_Point* size)
+{
+  auto it = cachedGroups.find(idFor(id).hash);
+  if (it == cachedGroups.end() || it->second.key != key ||
+      !it->second.texture) {
+    return nullptr;
+  }
+  auto& entry = it->second;
+  entry.lastUsed = frameCount;
+  *size = entry.size;
+  return entry.texture;
+}
+
+inline void
+State::cacheGroup(std::string_view id,
+                  Uint64 key,
+                  size_t first,
+                  const SDL_Rect& rect)
+{
+  if (!renderer) {
+    return;
+  }
+  auto hash = idFor(id).hash;
+  auto it = cachedGroups.find(hash);
+  if (it == cachedGroups.end() || it->second.key != key) {
+    // Just remember the key, to see if it stays
+    releaseCachedGroup(hash);
+    auto& entry = cachedGroups[hash];
+    entry.key = key;
+    entry.size = {rect.w, rect.h};
+    entry.lastUsed = frameCount;
+    return;
+  }
+  auto& entry = it->second;
+  entry.lastUsed = frameCount;
+  if (entry.pending || entry.texture) {
+    return;
+  }
+  size_t bytes = size_t(rect.w) * rect.h * 4;
+  if (bytes == 0 || bytes > groupCacheLimit ||
+      entry.size.x != rect.w || entry.size.y != rect.h ||
+      !SDL_RenderTargetSupported(renderer)) {
+    entry.size = {rect.w, rect.h};
+    return;
+  }
+  while (groupCacheBytes + bytes > groupCacheLimit) {
+    if (!evictCachedGroup()) {
+      return;
+    }
+  }
+  dList.copyTo(entry.commands, first, {-rect.x, -rect.y});
+  entry.pending = true;
+  groupCacheBytes += bytes;
+}
+
+inline void
+State::renderCachedGroups()
 {
-  auto groupSize = group.size();
-  if (qualifiedId.size() < groupSize + 1) {
-    return false;
+  if (!renderer) {
+    return;
+  }
+  SDL_Texture* target = nullptr;
+  SDL_BlendMode blendMode;
+  Uint8 r, g, b, a;
+  bool saved = false;
+  for (auto& [id, entry] : cachedGroups) {
+    if (!entry.pending) {
+      continue;
+    }
+    if (!saved) {
+      target = SDL_GetRenderTarget(renderer);
+      SDL_GetRenderDrawBlendMode(renderer, &blendMode);
+      SDL_GetRenderDrawColor(renderer, &r, &g, &b, &a);
+      saved = true;
+    }
+    entry.pending = false;
+    entry.texture = SDL_CreateTexture(renderer,
+                                      SDL_PIXELFORMAT_RGBA32,
+                                      SDL_TEXTUREACCESS_TARGET,
+                                      entry.size.x,
+                                      entry.size.y);
+    if (!entry.texture || SDL_SetRenderTarget(renderer, entry.texture) != 0) {
+      if (entry.texture) {
+        SDL_DestroyTexture(entry.texture);
+        entry.texture = nullptr;
+      }
+      groupCacheBytes -= size_t(entry.size.x) * entry.size.y * 4;
+      entry.commands.clear();
+      continue;
+    }
+    // Rendering over transparent pixels leaves them premultiplied by alpha
+    auto premultiplied = SDL_ComposeCustomBlendMode(
+      SDL_BLENDFACTOR_ONE,
+      SDL_BLENDFACTOR_ONE_MINUS_SRC_ALPHA,
+      SDL_BLENDOPERATION_ADD,
+      SDL_BLENDFACTOR_ONE,
+      SDL_BLENDFACTOR_ONE_MINUS_SRC_ALPHA,
+      SDL_BLENDOPERATION_ADD);
+    if (SDL_SetTextureBlendMode(entry.texture, premultiplied) != 0) {
+      SDL_SetTextureBlendMode(entry.texture, SDL_BLENDMODE_BLEND);
+    }
+    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_NONE);
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0);
+    SDL_RenderClear(renderer);
+    entry.commands.render(renderer);
+    entry.commands.clear();
   }
-  if (qualifiedId.substr(0, groupSize) != group ||
-      qualifiedId[groupSize] != groupNameSeparator ||
-      qualifiedId.substr(groupSize + 1) != id) {
-    return false;
+  if (saved) {
+    SDL_SetRenderTarget(renderer, target);
+    SDL_SetRenderDrawBlendMode(renderer, blendMode);
+    SDL_SetRenderDrawColor(renderer, r, g, b, a);
   }
-  return true;
 }
 
 inline MouseAction
 State::checkMouse(std::string_view id, SDL_Rect r)
 {
   SDL_assert(inFrame);
+  ++frameStats.mouseChecks;
+  auto qualifiedId = idFor(id);
+  hitAreas.push_back({qualifiedId.hash, r});
   if (eGrabbed.empty()) {
     if (!mLeftPressed) {
       return MouseAction::NONE;
     }
-    if (SDL_PointInRect(&mPos, &r) && !mGrabbing) {
-      eGrabbed = group;
-      eGrabbed += groupNameSeparator;
-      eGrabbed += id;
-      eActive = group;
-      eActive += groupNameSeparator;
-      eActive += id;
-      gGrabbed = true;
-      gActive = true;
+    // Until there are areas from a previous frame, any element can be hit
+    bool hovered = lastHitAreas.empty() ? bool(SDL_PointInRect(&mPos, &r))
+                                        : mHovered == qualifiedId.hash;
+    if (hovered && !mGrabbing) {
+      eGrabbed = std::move(qualifiedId);
+      eActive = eGrabbed;
       mGrabbing = true;
       return MouseAction::GRAB;
     }
-    if (isSameGroupId(eActive, id)) {
+    if (eActive == qualifiedId) {
       eActive.clear();
     }
     return MouseAction::NONE;
   }
-  if (!isSameGroupId(eGrabbed, id)) {
+  if (eGrabbed != qualifiedId) {
     return MouseAction::NONE;
   }
-  gGrabbed = true;
   if (mLeftPressed) {
     if (mGrabbing) {
       return MouseAction::GRAB;
@@ -291,80 +1209,65 @@ inline void
 State::beginGroup(std::string_view id, const SDL_Rect& r)
 {
   dList.popClip();
+  ++frameStats.groups;
   if (id.empty()) {
     return;
   }
-  auto idSize = id.size();
-  auto groupSize = group.size();
-  if (groupSize > 0) {
-    group += groupNameSeparator;
-    if (!gGrabbed || eGrabbed.size() <= idSize + groupSize + 1 ||
-        std::string_view{eGrabbed}.substr(groupSize, idSize + 1) != id ||
-        eGrabbed[groupSize + idSize + 1] != groupNameSeparator) {
-      gGrabbed = false;
-    }
-    if (!gActive || eActive.size() <= idSize + groupSize + 1 ||
-        std::string_view{eActive}.substr(groupSize, idSize + 1) != id ||
-        eActive[groupSize + idSize + 1] != groupNameSeparator) {
-      gActive = false;
-    }
-  } else {
-    if (eGrabbed.size() <= idSize ||
-        std::string_view{eGrabbed}.substr(0, idSize) != id ||
-        eGrabbed[idSize] != groupNameSeparator) {
-      gGrabbed = false;
-    } else {
-      gGrabbed = true;
-    }
-    if (eActive.size() <= idSize ||
-        std::string_view{eActive}.substr(0, idSize) != id ||
-        eActive[idSize] != groupNameSeparator) {
-      gActive = false;
-    } else {
-      gActive = true;
-    }
-  }
-  group += id;
+  groupStack.push_back(group);
+  group = combineId(group, id);
 }
 
 inline void
 State::endGroup(std::string_view id, const SDL_Rect& r)
 {
-  if (id.empty()) {
-    // Nothing to do
-  } else if (id.size() >= group.size()) {
-    // A top level group
-    SDL_assert(group == id);
-    group.clear();
-    gActive = gGrabbed = false;
-    if (!mHovering && SDL_PointInRect(&mPos, &r)) {
-      mHovering = true;
-    }
-  } else {
-    auto groupSize = group.size();
-    auto nextSize = groupSize - id.size() - 1;
-    SDL_assert(group[nextSize] == groupNameSeparator);
-    SDL_assert(std::string_view{group}.substr(nextSize + 1) == id);
-
-    group.erase(group.begin() + nextSize, group.end());
-    if (!gGrabbed && eGrabbed.size() > nextSize &&
-        std::string_view{eGrabbed}.substr(0, nextSize) == group &&
-        eGrabbed[nextSize] == groupNameSeparator) {
-      gGrabbed = true;
-    }
-    if (!gActive && eActive.size() > nextSize &&
-        std::string_view{eActive}.substr(0, nextSize) == group &&
-        eActive[nextSize] == groupNameSeparator) {
-      gActive = true;
+  if (!id.empty()) {
+    SDL_assert(!groupStack.empty());
+    SDL_assert(group == combineId(groupStack.back(), id));
+    sizes.push_back({group.hash, {r.w, r.h}});
+    group = std::move(groupStack.back());
+    groupStack.pop_back();
+    if (groupStack.empty()) {
+      // A top level group, hiding the areas below it
+      hitAreas.push_back({0, r});
+      if (!mHovering && SDL_PointInRect(&mPos, &r)) {
+        mHovering = true;
+      }
     }
   }
   dList.pushClip(r);
 }
 
+inline bool
+State::waitEvent(SDL_Event* ev)
+{
+  SDL_assert(!inFrame);
+  if (dirty || waited) {
+    return SDL_PollEvent(ev);
+  }
+  waited = true;
+  if (nextFrameTicks == 0) {
+    return SDL_WaitEvent(ev);
+  }
+  int timeout = nextFrameTicks - SDL_GetTicks();
+  if (timeout <= 0) {
+    return SDL_PollEvent(ev);
+  }
+  return SDL_WaitEventTimeout(ev, timeout);
+}
+
 inline void
 State::event(SDL_Event& ev)
 {
-  if (ev.type == SDL_MOUSEBUTTONDOWN) {
+  if (ev.type == SDL_WINDOWEVENT || ev.type == SDL_RENDER_TARGETS_RESET ||
+      ev.type == SDL_RENDER_DEVICE_RESET) {
+    // Screen content might be lost
+    forceRedraw = true;
+    if (ev.type != SDL_WINDOWEVENT) {
+      dList.invalidateCanvas();
+      // Render target textures lost their content, rebuilt on the next frame
+      targetsLost = true;
+    }
+  } else if (ev.type == SDL_MOUSEBUTTONDOWN) {
     mPos = {ev.button.x, ev.button.y};
     if (ev.button.button == SDL_BUTTON_LEFT) {
       mLeftPressed = true;
@@ -380,20 +1283,7 @@ State::event(SDL_Event& ev)
     if (eActive.empty()) {
       return;
     }
-    for (int i = 0, j = 0; i < SDL_TEXTINPUTEVENT_TEXT_SIZE; ++i) {
-      tBuffer[j] = ev.text.text[i];
-      if (tBuffer[j] == 0) {
-        break;
-      }
-      // Magic handling of utf8
-      if ((tBuffer[j] & 0xc0) == 0x80) {
-        continue;
-      }
-      if ((tBuffer[j] & 0x80) != 0) {
-        tBuffer[j] = '\x0f'; // This is valid on our particular font
-      }
-      ++j;
-    }
+    SDL_strlcpy(tBuffer, ev.text.text, SDL_TEXTINPUTEVENT_TEXT_SIZE);
     tChanged = true;
     tAction = TextAction::INPUT;
   } else if (ev.type == SDL_KEYDOWN) {
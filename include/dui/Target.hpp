@@ -1,12 +1,40 @@
 #ifndef DUI_TARGET_HPP_
 #define DUI_TARGET_HPP_
 
+#include <algorithm>
+#include <climits>
 #include <SDL.h>
 #include "State.hpp"
 #include "TargetStyle.hpp"
 
 namespace dui {
 
+/// A rect containing (almost) everything int coordinates can reach
+constexpr SDL_Rect unboundedRect{INT_MIN / 2, INT_MIN / 2, INT_MAX, INT_MAX};
+
+/**
+ * @brief The part of r inside the visible rect
+ *
+ * A 0 width or height on r means it extends as far as visible does.
+ */
+inline SDL_Rect
+clipVisible(const SDL_Rect& visible, const SDL_Rect& r)
+{
+  Sint64 x0 = std::max(visible.x, r.x);
+  Sint64 y0 = std::max(visible.y, r.y);
+  Sint64 x1 = Sint64(visible.x) + visible.w;
+  Sint64 y1 = Sint64(visible.y) + visible.h;
+  if (r.w != 0) {
+    x1 = std::min(x1, Sint64(r.x) + r.w);
+  }
+  if (r.h != 0) {
+    y1 = std::min(y1, Sint64(r.y) + r.h);
+  }
+  Sint64 w = std::max<Sint64>(x1 - x0, 0);
+  Sint64 h = std::max<Sint64>(y1 - y0, 0);
+  return {int(x0), int(y0), int(w), int(h)};
+}
+
 /**
  * @brief A target where elements can be added to
  *
@@ -20,6 +48,7 @@ class Target
   SDL_Point* bottomRight = nullptr;
   bool* locked = nullptr;
   TargetStyle style;
+  SDL_Rect visible = unboundedRect;
 
   static constexpr int makeLen(int len,
                                int delta,
@@ -47,7 +76,8 @@ public:
          SDL_Point& topLeft,
          SDL_Point& bottomRight,
          bool& locked,
-         TargetStyle style)
+         TargetStyle style,
+         const SDL_Rect& visible = unboundedRect)
     : state(state)
     , id(id)
     , rect(&rect)
@@ -55,6 +85,7 @@ public:
     , bottomRight(&bottomRight)
     , locked(&locked)
     , style(style)
+    , visible(visible)
   {}
 
   /**
@@ -75,6 +106,19 @@ public:
    */
   bool isActive(std::string_view id) const { return state->isActive(id); }
 
+  /**
+   * @brief Persistent storage for a contained element
+   *
+   * @param id the element id
+   * @return the value for this id and type
+   * @see State::storage()
+   */
+  template<class T>
+  T& storage(std::string_view id) const
+  {
+    return state->storage<T>(id);
+  }
+
   /**
    * @brief Check the text action/status for element in this group
    *
@@ -152,6 +196,20 @@ public:
     return caret;
   }
 
+  /// The global area where elements can be seen, for culling
+  const SDL_Rect& getVisible() const { return visible; }
+
+  /**
+   * @brief Check if any part of the given global rect can be seen
+   *
+   * Elements might skip displaying anything when this is false, but they must
+   * still advance the caret.
+   */
+  bool isVisible(const SDL_Rect& r) const
+  {
+    return SDL_HasIntersection(&visible, &r);
+  }
+
   /// Return true if there is a subtarget active.
   /// You can not add an element to target if until that subtarget is
   /// finished.
@@ -197,6 +255,21 @@ public:
   /// Get the height currently occupied by elements contained in this group
   int contentHeight() const { return bottomRight->y - topLeft->y; }
 
+  /**
+   * @brief The size this had at the end of the last frame
+   *
+   * Only groups with an id are remembered.
+   *
+   * @return the size, or {0, 0} if unknown
+   */
+  SDL_Point lastSize() const
+  {
+    if (id.empty() || *locked) {
+      return {0, 0};
+    }
+    return state->lastGroupSize();
+  }
+
   /// To be used internally
   void lock(std::string_view id, SDL_Rect r)
   {
@@ -230,7 +303,10 @@ Target::checkMouse(std::string_view id, SDL_Rect r)
   SDL_Point caret = getCaret();
   r.x += caret.x;
   r.y += caret.y;
-  return state->checkMouse(id, r);
+  // Parts outside the visible area can not be hit
+  SDL_Rect hitRect{r.x, r.y, 0, 0};
+  SDL_IntersectRect(&r, &visible, &hitRect);
+  return state->checkMouse(id, hitRect);
 }
 
 inline void
@@ -5,21 +5,42 @@
 #include "Group.hpp"
 #include "TextStyle.hpp"
 #include "Theme.hpp"
+#include "Utf8.hpp"
 
 namespace dui {
 
-/// Measure the given character
-constexpr SDL_Point
-measure(char ch, const Font& font, int scale)
+/// Measure the given code point
+inline SDL_Point
+measure(Uint32 codepoint, const Font& font, int scale)
 {
-  return {font.charW << scale, font.charH << scale};
+  return {glyphFor(font, codepoint).advance << scale, font.charH << scale};
 }
 
-/// Measure the given text
-constexpr SDL_Point
+/**
+ * @brief Measure the given UTF-8 text
+ *
+ * Glyphs not yet added to a font with cache are measured as its fallback, use
+ * the overload with target to avoid that.
+ */
+inline SDL_Point
 measure(std::string_view text, const Font& font, int scale)
 {
-  return {int((font.charW << scale) * text.size()), font.charH << scale};
+  return {textWidth(text, font) << scale, font.charH << scale};
+}
+
+/**
+ * @brief Measure the given text, using the state's cache
+ *
+ * @param target the target whose state holds the cache
+ * @param text the text
+ * @param font the font. If it has no texture, the state's font is used
+ * @param scale the scale
+ */
+inline SDL_Point
+measure(Target target, std::string_view text, const Font& font, int scale)
+{
+  auto& state = target.getState();
+  return state.measure(text, font.texture ? font : state.getFont(), scale);
 }
 
 /**
@@ -27,13 +48,13 @@ measure(std::string_view text, const Font& font, int scale)
  * @ingroup elements
  *
  * @param target the parent group or frame
- * @param ch the character
+ * @param codepoint the character's Unicode code point
  * @param p the position
  * @param style
  */
 inline void
 character(Target target,
-          char ch,
+          Uint32 codepoint,
           const SDL_Point& p,
           const TextStyle& style = themeFor<Text>())
 {
@@ -43,17 +64,15 @@ character(Target target,
   auto& font = state.getFont();
   SDL_assert(font.texture != nullptr);
 
+  char buffer[4];
+  std::string_view str{buffer, encodeUtf8(codepoint, buffer)};
   auto caret = target.getCaret();
-  SDL_Rect dstRect{p.x + caret.x,
-                   p.y + caret.y,
-                   font.charW << style.scale,
-                   font.charH << style.scale};
-  target.advance({p.x + dstRect.w, p.y + dstRect.h});
-  SDL_Rect srcRect{(ch % font.cols) * font.charW,
-                   (ch / font.cols) * font.charH,
-                   font.charW,
-                   font.charH};
-  state.display(Shape::Texture(dstRect, font.texture, srcRect, style.color));
+  auto sz = state.measure(str, font, style.scale);
+  target.advance({p.x + sz.x, p.y + sz.y});
+  SDL_Rect r{p.x + caret.x, p.y + caret.y, sz.x, sz.y};
+  if (target.isVisible(r)) {
+    state.display(str, {r.x, r.y}, font, style.scale, style.color, sz.x);
+  }
 }
 
 /**
@@ -61,7 +80,7 @@ character(Target target,
  * @ingroup elements
  *
  * @param target the parent group or frame
- * @param str the text
+ * @param str the UTF-8 text
  * @param p the position
  * @param style
  */
@@ -74,22 +93,15 @@ text(Target target,
   auto& state = target.getState();
   SDL_assert(state.isInFrame());
   SDL_assert(!target.isLocked());
-  auto font = style.font.texture ? style.font : state.getFont();
+  auto& font = style.font.texture ? style.font : state.getFont();
   SDL_assert(font.texture != nullptr);
 
   auto caret = target.getCaret();
-  SDL_Rect dstRect{p.x + caret.x,
-                   p.y + caret.y,
-                   font.charW << style.scale,
-                   font.charH << style.scale};
-  target.advance({p.x + dstRect.w * int(str.size()), p.y + dstRect.h});
-  for (auto ch : str) {
-    SDL_Rect srcRect{(ch % font.cols) * font.charW,
-                     (ch / font.cols) * font.charH,
-                     font.charW,
-                     font.charH};
-    state.display(Shape::Texture(dstRect, font.texture, srcRect, style.color));
-    dstRect.x += dstRect.w;
+  auto sz = state.measure(str, font, style.scale);
+  target.advance({p.x + sz.x, p.y + sz.y});
+  SDL_Rect r{p.x + caret.x, p.y + caret.y, sz.x, sz.y};
+  if (target.isVisible(r)) {
+    state.display(str, {r.x, r.y}, font, style.scale, style.color, sz.x);
   }
 }
 } // namespace dui
@@ -0,0 +1,343 @@
+#ifndef DUI_TEXT_AREA_HPP
+#define DUI_TEXT_AREA_HPP
+
+#include <algorithm>
+#include <string_view>
+#include "Element.hpp"
+#include "InputBoxStyle.hpp"
+#include "Panel.hpp"
+#include "Text.hpp"
+#include "TextBuffer.hpp"
+#include "Utf8.hpp"
+
+namespace dui {
+
+/// Eval the text area rect, accordingly to parameters
+inline SDL_Rect
+makeTextAreaRect(SDL_Rect r, const InputBoxStyle& style)
+{
+  if (r.w != 0 && r.h != 0) {
+    return r;
+  }
+  auto clientSz = measure('m', style.font, style.scale);
+  clientSz.x *= 32;
+  clientSz.y *= 8;
+  auto elementSz = elementSize(style.padding + style.border, clientSz);
+  if (r.w == 0) {
+    r.w = elementSz.x;
+  }
+  if (r.h == 0) {
+    r.h = elementSz.y;
+  }
+  return r;
+}
+
+/// Move the cursor to line, keeping its column in code points
+inline void
+moveTextCursorTo(TextBuffer& buffer, size_t line)
+{
+  size_t current = buffer.lineOf(buffer.cursor);
+  size_t start = buffer.lineStart(current);
+  auto before = buffer.line(current).substr(0, buffer.cursor - start);
+  size_t column = utf8Length(before);
+  size_t offset = utf8Offset(buffer.line(line), column);
+  buffer.cursor = buffer.lineStart(line) + offset;
+}
+
+/**
+ * @brief Apply an editing key to a TextBuffer
+ *
+ * @param buffer the buffer, edited at its cursor
+ * @param keysym the key
+ * @param pageLines the lines to move on page up and down
+ * @return true if the text changed
+ */
+inline bool
+textAreaKey(TextBuffer& buffer, const SDL_Keysym& keysym, size_t pageLines)
+{
+  size_t line = buffer.lineOf(buffer.cursor);
+  bool ctrl = keysym.mod & KMOD_CTRL;
+  switch (keysym.sym) {
+    case SDLK_BACKSPACE:
+      if (buffer.cursor > 0) {
+        size_t prev = buffer.prev(buffer.cursor);
+        buffer.erase(prev, buffer.cursor - prev);
+        buffer.cursor = prev;
+        return true;
+      }
+      break;
+    case SDLK_DELETE:
+      if (buffer.cursor < buffer.size()) {
+        size_t next = buffer.next(buffer.cursor);
+        buffer.erase(buffer.cursor, next - buffer.cursor);
+        return true;
+      }
+      break;
+    case SDLK_RETURN:
+    case SDLK_KP_ENTER:
+      buffer.insert(buffer.cursor, "\n");
+      buffer.cursor += 1;
+      return true;
+    case SDLK_LEFT:
+      buffer.cursor = buffer.prev(buffer.cursor);
+      break;
+    case SDLK_RIGHT:
+      buffer.cursor = buffer.next(buffer.cursor);
+      break;
+    case SDLK_UP:
+      if (line > 0) {
+        moveTextCursorTo(buffer, line - 1);
+      }
+      break;
+    case SDLK_DOWN:
+      if (line + 1 < buffer.lineCount()) {
+        moveTextCursorTo(buffer, line + 1);
+      }
+      break;
+    case SDLK_PAGEUP:
+      moveTextCursorTo(buffer, line > pageLines ? line - pageLines : 0);
+      break;
+    case SDLK_PAGEDOWN:
+      moveTextCursorTo(buffer,
+                       std::min(line + pageLines, buffer.lineCount() - 1));
+      break;
+    case SDLK_HOME:
+      buffer.cursor = ctrl ? 0 : buffer.lineStart(line);
+      break;
+    case SDLK_END:
+      buffer.cursor = ctrl ? buffer.size() : buffer.lineEnd(line);
+      break;
+    default:
+      break;
+  }
+  return false;
+}
+
+/// The width of the text from start to end, without moving the gap
+inline int
+textAreaWidth(const TextBuffer& buffer,
+              size_t start,
+              size_t end,
+              const Font& font,
+              int scale)
+{
+  int width = 0;
+  while (start < end) {
+    auto str = buffer.chunk(start).substr(0, end - start);
+    if (font.cache) {
+      font.cache->addMetrics(str);
+    }
+    width += textWidth(str, font);
+    start += str.size();
+  }
+  return width << scale;
+}
+
+/**
+ * @brief The part of a line shown from x to x + width, in whole code points
+ *
+ * Only the code points up to the end of the part shown are walked, and only
+ * that part is made contiguous, so long lines cost what is visible of them.
+ *
+ * @param buffer the text
+ * @param line the line index
+ * @param x the first pixel shown, from the line start
+ * @param width the width shown
+ * @param font the font
+ * @param scale the font scale
+ * @param skipped set to the width of the text before the part shown
+ * @return the part shown, valid until the next change on buffer
+ */
+inline std::string_view
+visibleTextLine(TextBuffer& buffer,
+                size_t line,
+                int x,
+                int width,
+                const Font& font,
+                int scale,
+                int* skipped)
+{
+  size_t start = buffer.lineStart(line);
+  size_t end = buffer.lineEnd(line);
+  size_t pos = start;
+  int startX = 0;
+  if (isMonospace(font) && x > 0) {
+    // Skip without measuring, but for the last code point, that might overhang
+    size_t count = x / (font.charW << scale);
+    size_t done = 0;
+    while (pos < end && done + 1 < count) {
+      auto str = buffer.chunk(pos).substr(0, end - pos);
+      size_t offset = utf8Offset(str, count - 1 - done);
+      done += offset < str.size() ? count - 1 - done : utf8Length(str);
+      pos += offset;
+    }
+    start = pos;
+    startX = int(done) * (font.charW << scale);
+  }
+
+  // Keep from the first glyph drawn after x to the last one drawn before the
+  // end, wherever they are drawn from their pen position
+  int lineX = startX;
+  bool skipping = true;
+  while (pos < end) {
+    char bytes[4];
+    size_t next = buffer.next(pos);
+    size_t count = std::min(next - pos, sizeof(bytes));
+    for (size_t i = 0; i < count; ++i) {
+      bytes[i] = buffer[pos + i];
+    }
+    std::string_view str{bytes, count};
+    if (font.cache) {
+      font.cache->addMetrics(str);
+    }
+    size_t index = 0;
+    auto glyph = glyphFor(font, decodeUtf8(str, index));
+    int left = lineX + glyph.offset.x * (1 << scale);
+    if (std::min(left, lineX) >= x + width) {
+      break;
+    }
+    int right = left + (glyph.srcRect.w << scale);
+    lineX += glyph.advance << scale;
+    pos = next;
+    if (skipping && right <= x) {
+      start = pos;
+      startX = lineX;
+    } else {
+      skipping = false;
+    }
+  }
+  *skipped = startX;
+  return buffer.view(start, pos - start);
+}
+
+/**
+ * @brief A multi line text box
+ * @ingroup elements
+ *
+ * The text is kept on a TextBuffer, along with the cursor and the scrolling,
+ * so edits cost the same however large the text is. Only the visible part
+ * of the visible lines is measured and displayed.
+ *
+ * @param target the parent group or frame
+ * @param id the id
+ * @param value the text. It must be a different one for each text area
+ * @param r the relative position and size. If size is 0 it will use a default
+ * size, of 32 by 8 characters
+ * @param style
+ * @return true if the text changed
+ */
+inline bool
+textArea(Target target,
+         std::string_view id,
+         TextBuffer* value,
+         const SDL_Rect& r = {0},
+         const InputBoxStyle& style = themeFor<TextArea>())
+{
+  SDL_assert(value != nullptr);
+  auto& buffer = *value;
+  auto& state = target.getState();
+  auto& font = style.font.texture ? style.font : state.getFont();
+  int lineHeight = font.charH << style.scale;
+  auto rect = makeTextAreaRect(r, style);
+  auto edges = style.padding + style.border;
+  auto clientSz = clientSize(edges, {rect.w, rect.h});
+  size_t rows = std::max(clientSz.y / lineHeight, 1);
+  if (buffer.cursor > buffer.size()) {
+    buffer.cursor = buffer.size();
+  }
+
+  if (target.checkMouse(id, rect) == MouseAction::GRAB) {
+    // Place the cursor at the nearest code point boundary
+    auto mouse = state.lastMousePos();
+    auto caret = target.getCaret();
+    int x = mouse.x - caret.x - rect.x - edges.left + buffer.scrollX;
+    int y = mouse.y - caret.y - rect.y - edges.top;
+    size_t line = std::min(buffer.topLine + std::max(y, 0) / lineHeight,
+                           buffer.lineCount() - 1);
+    auto text = buffer.line(line);
+    size_t offset = 0;
+    for (int width = 0; offset < text.size();) {
+      size_t next = offset;
+      int advance = measure(decodeUtf8(text, next), font, style.scale).x;
+      if (width + advance / 2 > x) {
+        break;
+      }
+      width += advance;
+      offset = next;
+    }
+    buffer.cursor = buffer.lineStart(line) + offset;
+  }
+
+  bool changed = false;
+  auto action = target.checkText(id);
+  if (action == TextAction::INPUT) {
+    auto insert = target.lastText();
+    buffer.insert(buffer.cursor, insert);
+    buffer.cursor += insert.size();
+    changed = true;
+  } else if (action == TextAction::KEYDOWN) {
+    changed = textAreaKey(buffer, target.lastKeyDown(), rows);
+  }
+
+  // Scroll to keep the cursor visible
+  bool active = action == TextAction::NONE ? target.isActive(id) : true;
+  size_t cursorLine = buffer.lineOf(buffer.cursor);
+  int cursorX = 0;
+  if (active) {
+    if (cursorLine < buffer.topLine) {
+      buffer.topLine = cursorLine;
+    } else if (cursorLine >= buffer.topLine + rows) {
+      buffer.topLine = cursorLine + 1 - rows;
+    }
+    // Not on the measure cache, as long lines would be hashed every frame
+    cursorX = textAreaWidth(buffer,
+                            buffer.lineStart(cursorLine),
+                            buffer.cursor,
+                            font,
+                            style.scale);
+    if (cursorX < buffer.scrollX) {
+      buffer.scrollX = cursorX;
+    } else if (cursorX >= buffer.scrollX + clientSz.x) {
+      buffer.scrollX = cursorX - clientSz.x + 1;
+    }
+  }
+  buffer.topLine = std::min(buffer.topLine, buffer.lineCount() - 1);
+
+  auto& currentColors = active ? style.active : style.normal;
+  auto g = panel(target,
+                 id,
+                 rect,
+                 Layout::NONE,
+                 {style.padding, style.border, currentColors});
+  if (active) {
+    auto ticks = state.ticks();
+    if ((ticks / 512) % 2) {
+      int cursorY = int(cursorLine - buffer.topLine) * lineHeight;
+      colorBox(g,
+               {cursorX - buffer.scrollX, cursorY, 1, lineHeight},
+               currentColors.text);
+    }
+    state.requestFrameAt((ticks / 512 + 1) * 512);
+  }
+  size_t last = std::min(buffer.topLine + rows + 1, buffer.lineCount());
+  for (size_t i = buffer.topLine; i < last; ++i) {
+    int skipped;
+    auto shown = visibleTextLine(buffer,
+                                 i,
+                                 buffer.scrollX,
+                                 clientSz.x,
+                                 font,
+                                 style.scale,
+                                 &skipped);
+    text(g,
+         shown,
+         {skipped - buffer.scrollX, int(i - buffer.topLine) * lineHeight},
+         {font, currentColors.text, style.scale});
+  }
+  g.end();
+  return changed;
+}
+
+} // namespace dui
+
+#endif // DUI_TEXT_AREA_HPP
@@ -0,0 +1,282 @@
+#ifndef DUI_TEXT_BUFFER_HPP
+#define DUI_TEXT_BUFFER_HPP
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <SDL.h>
+
+namespace dui {
+
+/**
+ * @brief Editable text for large documents, as used by textArea()
+ *
+ * The text is kept in a gap buffer: the free space sits where the last edit
+ * happened, so typing costs the same whatever the text size, and moving the
+ * cursor only moves the text between the old and the new position.
+ *
+ * It also keeps the start of each line, as positions in the buffer instead of
+ * in the text, so edits at the gap only touch the lines they add or remove.
+ *
+ * Positions are in bytes, and the text is meant to be UTF-8.
+ */
+class TextBuffer
+{
+  std::vector<char> data; // The text, with a gap in [gapStart, gapEnd)
+  size_t gapStart = 0;
+  size_t gapEnd = 0;
+
+  // Line starts, as indices on data. A start at gapStart counts as before the
+  // gap, so inserting there does not move it.
+  std::vector<size_t> lines{0};
+
+  size_t gapSize() const { return gapEnd - gapStart; }
+
+  // The index on lines of a text position
+  size_t lineIndex(size_t pos) const
+  {
+    return pos <= gapStart ? pos : pos + gapSize();
+  }
+
+  // The index on data of the character at a text position
+  size_t charIndex(size_t pos) const
+  {
+    return pos < gapStart ? pos : pos + gapSize();
+  }
+
+  void moveGap(size_t pos);
+  void reserveGap(size_t count);
+
+public:
+  /// Byte offset of the cursor, kept by textArea()
+  size_t cursor = 0;
+
+  /// The first line shown by textArea()
+  size_t topLine = 0;
+
+  /// The horizontal scroll of textArea(), in pixels
+  int scrollX = 0;
+
+  /// Ctor
+  TextBuffer() = default;
+
+  /// Ctor
+  explicit TextBuffer(std::string_view text) { assign(text); }
+
+  /// Replace the text, moving the cursor to the start
+  void assign(std::string_view text);
+
+  /// The text size in bytes
+  size_t size() const { return data.size() - gapSize(); }
+
+  /// If true there is no text
+  bool empty() const { return size() == 0; }
+
+  /// The number of lines, at least 1
+  size_t lineCount() const { return lines.size(); }
+
+  /// The position where the given line starts
+  size_t lineStart(size_t line) const
+  {
+    SDL_assert(line < lines.size());
+    auto index = lines[line];
+    return index <= gapStart ? index : index - gapSize();
+  }
+
+  /// The position where the given line ends, before its line break
+  size_t lineEnd(size_t line) const
+  {
+    return line + 1 < lines.size() ? lineStart(line + 1) - 1 : size();
+  }
+
+  /// The line containing the given position
+  size_t lineOf(size_t pos) const
+  {
+    SDL_assert(pos <= size());
+    auto it = std::upper_bound(lines.begin(), lines.end(), lineIndex(pos));
+    return it - lines.begin() - 1;
+  }
+
+  /// The character at a position
+  char operator[](size_t pos) const
+  {
+    SDL_assert(pos < size());
+    return data[charIndex(pos)];
+  }
+
+  /// The start of the code point before pos, or 0
+  size_t prev(size_t pos) const
+  {
+    SDL_assert(pos <= size());
+    while (pos > 0 && (Uint8((*this)[--pos]) & 0xc0) == 0x80) {
+    }
+    return pos;
+  }
+
+  /// The start of the code point after the one at pos, or size()
+  size_t next(size_t pos) const
+  {
+    SDL_assert(pos <= size());
+    size_t end = size();
+    if (pos < end) {
+      ++pos;
+    }
+    while (pos < end && (Uint8((*this)[pos]) & 0xc0) == 0x80) {
+      ++pos;
+    }
+    return pos;
+  }
+
+  /// The text from a position up to the gap, or to the end if after it
+  std::string_view chunk(size_t pos) const
+  {
+    SDL_assert(pos <= size());
+    if (pos < gapStart) {
+      return {data.data() + pos, gapStart - pos};
+    }
+    return {data.data() + pos + gapSize(), size() - pos};
+  }
+
+  /**
+   * @brief The text from a position, count bytes long
+   *
+   * If the gap is inside it, it is moved to its end, so the view is valid
+   * until the next change.
+   */
+  std::string_view view(size_t pos, size_t count);
+
+  /// The text of a line, without its line break. @see view()
+  std::string_view line(size_t line)
+  {
+    size_t start = lineStart(line);
+    return view(start, lineEnd(line) - start);
+  }
+
+  /// A copy of the whole text
+  std::string str() const
+  {
+    std::string result{data.data(), gapStart};
+    result.append(data.data() + gapEnd, data.size() - gapEnd);
+    return result;
+  }
+
+  /// Insert text at a position
+  void insert(size_t pos, std::string_view text);
+
+  /// Erase count bytes from a position
+  void erase(size_t pos, size_t count);
+};
+
+inline void
+TextBuffer::assign(std::string_view text)
+{
+  data.assign(text.begin(), text.end());
+  gapStart = gapEnd = data.size();
+  lines.assign(1, 0);
+  for (size_t i = 0; i < text.size(); ++i) {
+    if (text[i] == '\n') {
+      lines.push_back(i + 1);
+    }
+  }
+  cursor = 0;
+  topLine = 0;
+  scrollX = 0;
+}
+
+inline std::string_view
+TextBuffer::view(size_t pos, size_t count)
+{
+  SDL_assert(pos + count <= size());
+  if (pos < gapStart && gapStart < pos + count) {
+    moveGap(pos + count);
+  }
+  return {data.data() + charIndex(pos), count};
+}
+
+inline void
+TextBuffer::moveGap(size_t pos)
+{
+  SDL_assert(pos <= size());
+  size_t gap = gapSize();
+  if (pos < gapStart) {
+    size_t count = gapStart - pos;
+    std::memmove(&data[gapEnd - count], &data[pos], count);
+    auto first = std::upper_bound(lines.begin(), lines.end(), pos);
+    auto last = std::upper_bound(first, lines.end(), gapStart);
+    for (; first != last; ++first) {
+      *first += gap;
+    }
+    gapStart -= count;
+    gapEnd -= count;
+  } else if (pos > gapStart) {
+    size_t count = pos - gapStart;
+    std::memmove(&data[gapStart], &data[gapEnd], count);
+    auto first = std::upper_bound(lines.begin(), lines.end(), gapEnd);
+    auto last = std::upper_bound(first, lines.end(), pos + gap);
+    for (; first != last; ++first) {
+      *first -= gap;
+    }
+    gapStart += count;
+    gapEnd += count;
+  }
+}
+
+inline void
+TextBuffer::reserveGap(size_t count)
+{
+  if (gapSize() >= count) {
+    return;
+  }
+  // Grow proportionally to the text, so typing is amortized O(1)
+  size_t delta = std::max(count, size() / 8 + 64) - gapSize();
+  data.insert(data.begin() + gapEnd, delta, '\0');
+  auto first = std::upper_bound(lines.begin(), lines.end(), gapStart);
+  for (; first != lines.end(); ++first) {
+    *first += delta;
+  }
+  gapEnd += delta;
+}
+
+inline void
+TextBuffer::insert(size_t pos, std::string_view text)
+{
+  if (text.empty()) {
+    return;
+  }
+  moveGap(pos);
+  reserveGap(text.size());
+  std::memcpy(&data[gapStart], text.data(), text.size());
+
+  // The new lines start before the gap once it moves past the text
+  size_t count = std::count(text.begin(), text.end(), '\n');
+  if (count > 0) {
+    auto it = std::upper_bound(lines.begin(), lines.end(), gapStart);
+    it = lines.insert(it, count, 0);
+    for (size_t i = 0; i < text.size(); ++i) {
+      if (text[i] == '\n') {
+        *it++ = gapStart + i + 1;
+      }
+    }
+  }
+  gapStart += text.size();
+}
+
+inline void
+TextBuffer::erase(size_t pos, size_t count)
+{
+  SDL_assert(pos + count <= size());
+  if (count == 0) {
+    return;
+  }
+  moveGap(pos);
+  auto first = std::upper_bound(lines.begin(), lines.end(), gapEnd);
+  auto last = std::upper_bound(first, lines.end(), gapEnd + count);
+  lines.erase(first, last);
+  gapEnd += count;
+}
+
+} // namespace dui
+
+#endif // DUI_TEXT_BUFFER_HPP
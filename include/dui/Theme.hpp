@@ -1,8 +1,12 @@
 #ifndef DUI_THEME_HPP_
 #define DUI_THEME_HPP_
 
+#include <type_traits>
+
 namespace dui {
 
+class RuntimeTheme;
+
 namespace style {
 
 // Default theme
@@ -21,15 +25,66 @@ struct DerivedTheme
   static constexpr auto get() { return FromTheme<Element, BaseTheme>::get(); }
 };
 
+/// The style of each element, built once at compile time
+template<class Element, class Theme>
+inline constexpr auto themeStyle = FromTheme<Element, Theme>::get();
+
+/// The style type of an element
+template<class Element>
+using StyleFor = std::decay_t<decltype(FromTheme<Element, DUI_THEME>::get())>;
+
+/**
+ * @brief The theme of the State building a frame on this thread
+ *
+ * Set by State::beginFrame() and restored to what it was by endFrame(), so
+ * States on different threads, or one frame built inside another, each see
+ * their own theme. Outside a frame it is nullptr.
+ */
+inline thread_local const RuntimeTheme* activeTheme = nullptr;
+
 } // namespace style
 
+#ifndef DUI_RUNTIME_THEME
+
+/**
+ * @brief The style for an element on the given theme
+ *
+ * It refers to a single constant, so passing it to widgets copies nothing.
+ */
 template<class Element, class Theme = DUI_THEME>
-constexpr auto
+constexpr const auto&
 themeFor()
 {
-  return style::FromTheme<Element, Theme>::get();
+  return style::themeStyle<Element, Theme>;
 }
 
+#else
+
+/// The style for an element on the given theme
+template<class Element, class Theme>
+constexpr const auto&
+themeFor()
+{
+  return style::themeStyle<Element, Theme>;
+}
+
+/**
+ * @brief The style for an element on the theme of the current frame
+ *
+ * Only with DUI_RUNTIME_THEME defined. It is the style on State::getTheme()
+ * of the frame being built on this thread, or on DUI_THEME if it has none.
+ *
+ * Outside a frame it is always the one on DUI_THEME, so styles kept from
+ * before the frame starts, like default arguments evaluated then, do not
+ * follow the State theme. Defined on RuntimeTheme.hpp.
+ */
+template<class Element>
+const style::StyleFor<Element>&
+themeFor();
+
+#endif
+
+
 } // namespace dui
 
 #endif // DUI_THEME_HPP_
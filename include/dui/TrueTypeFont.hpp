@@ -0,0 +1,678 @@
+#ifndef DUI_TRUE_TYPE_FONT_HPP
+#define DUI_TRUE_TYPE_FONT_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include <SDL.h>
+#include "Font.hpp"
+#include "RenderBackend.hpp"
+
+namespace dui {
+
+/**
+ * @brief A font from TrueType data, with glyphs rasterized on demand
+ *
+ * Glyphs are rasterized (antialiased, without hinting) the first time they
+ * are displayed, into cells of an atlas texture with a fixed capacity. When it
+ * is full, the least recently used glyph is evicted to make room, but never
+ * one displayed on the current frame. If all are, the new glyph is not drawn
+ * and counted on misses(), so the capacity can be adjusted.
+ *
+ * Only fonts with TrueType outlines (glyf table) are supported, not the CFF
+ * ones.
+ *
+ * It must outlive the fonts returned by font() and be used by a single State.
+ */
+class TrueTypeFont : public GlyphCache
+{
+  struct Point
+  {
+    float x, y;
+    bool on; // On the curve, otherwise a quadratic control point
+  };
+
+  struct Transform
+  {
+    float a = 1, b = 0, c = 0, d = 1, dx = 0, dy = 0;
+  };
+
+  // Atlas cell, kept on a list from the most to the least recently used
+  struct Cell
+  {
+    Uint32 codepoint;
+    Uint32 frame;
+    int prev, next;
+  };
+
+  static constexpr int NOT_LOADED = -1;
+  static constexpr int NO_BITMAP = -2;
+
+  std::vector<Uint8> data;
+  Uint32 glyf = 0, loca = 0, hmtx = 0, cmap = 0;
+  int numGlyphs = 0, numHMetrics = 0;
+  bool longLoca = false;
+
+  float scale = 0;
+  int ascent = 0;
+  int lineHeight = 0;
+  int cellW = 0, cellH = 0;
+  int cols = 0;
+  int capacity;
+
+  SDLRenderBackend ownBackend;
+  RenderBackend* backend;
+  SDL_Texture* texture = nullptr;
+
+  GlyphMap glyphs;
+  // The cell of each code point on the map, NOT_LOADED or NO_BITMAP
+  int latin1Cells[256];
+  std::unordered_map<Uint32, int> otherCells;
+  std::vector<Cell> cells;
+  int head = -1, tail = -1;
+  Uint32 missCount = 0;
+
+  // Scratch buffers
+  std::vector<Point> points;
+  std::vector<int> contourEnds;
+  std::vector<Uint8> flags;
+  std::vector<float> accumulation;
+  std::vector<SDL_Color> pixels;
+
+  Uint32 read8(Uint32 offset) const
+  {
+    return offset < data.size() ? data[offset] : 0;
+  }
+  Uint32 read16(Uint32 offset) const
+  {
+    return read8(offset) << 8 | read8(offset + 1);
+  }
+  Uint32 read32(Uint32 offset) const
+  {
+    return read16(offset) << 16 | read16(offset + 2);
+  }
+  int readS16(Uint32 offset) const { return Sint16(read16(offset)); }
+  float readF2Dot14(Uint32 offset) const { return readS16(offset) / 16384.f; }
+
+  int& cellOf(Uint32 codepoint)
+  {
+    return codepoint < 256 ? latin1Cells[codepoint] : otherCells[codepoint];
+  }
+
+  Uint32 findTable(const char* tag) const;
+  void init(int pixelHeight);
+  int glyphIndex(Uint32 codepoint) const;
+  int advanceOf(int index) const;
+  void addGlyph(Uint32 codepoint);
+  void outline(int index, const Transform& t, int depth);
+  void drawLine(Point p0, Point p1, int w, int h);
+  void drawQuad(Point p0, Point p1, Point p2, int w, int h);
+  void rasterize(Uint32 codepoint, Uint32 frame);
+
+  void unlink(int cell);
+  void pushFront(int cell);
+
+public:
+  /**
+   * @brief Load a font for the SDL_Renderer
+   *
+   * @param renderer the renderer
+   * @param ttf the TrueType data, copied
+   * @param size the data size
+   * @param pixelHeight the line height in pixels
+   * @param capacity the max number of glyphs on the atlas
+   */
+  TrueTypeFont(SDL_Renderer* renderer,
+               const void* ttf,
+               size_t size,
+               int pixelHeight,
+               int capacity = 256)
+    : data(static_cast<const Uint8*>(ttf),
+           static_cast<const Uint8*>(ttf) + size)
+    , capacity(std::max(capacity, 1))
+    , ownBackend(renderer)
+    , backend(&ownBackend)
+  {
+    init(pixelHeight);
+  }
+
+  /**
+   * @brief Load a font for the given backend
+   *
+   * @param backend the backend, it must support createTexture()
+   * @param ttf the TrueType data, copied
+   * @param size the data size
+   * @param pixelHeight the line height in pixels
+   * @param capacity the max number of glyphs on the atlas
+   */
+  TrueTypeFont(RenderBackend& backend,
+               const void* ttf,
+               size_t size,
+               int pixelHeight,
+               int capacity = 256)
+    : data(static_cast<const Uint8*>(ttf),
+           static_cast<const Uint8*>(ttf) + size)
+    , capacity(std::max(capacity, 1))
+    , backend(&backend)
+  {
+    init(pixelHeight);
+  }
+
+  TrueTypeFont(const TrueTypeFont&) = delete;
+  TrueTypeFont& operator=(const TrueTypeFont&) = delete;
+
+  ~TrueTypeFont()
+  {
+    if (texture) {
+      backend->destroyTexture(texture);
+    }
+  }
+
+  /// True if the data could be parsed and the atlas created
+  bool isValid() const { return texture != nullptr; }
+
+  /// The font, to be used on State or styles
+  Font font()
+  {
+    return {texture, glyphs.get('m').advance, lineHeight, cols, &glyphs, this};
+  }
+
+  /// Number of glyphs that could not be loaded because the atlas was full
+  Uint32 misses() const { return missCount; }
+
+  void addMetrics(std::string_view text) final
+  {
+    if (!isValid()) {
+      return;
+    }
+    forEachCodepoint(text, [&](Uint32 codepoint) {
+      if (!glyphs.contains(codepoint)) {
+        addGlyph(codepoint);
+      }
+    });
+  }
+
+  void load(std::string_view text, Uint32 frame) final
+  {
+    if (!isValid()) {
+      return;
+    }
+    forEachCodepoint(text, [&](Uint32 codepoint) {
+      if (!glyphs.contains(codepoint)) {
+        addGlyph(codepoint);
+      }
+      int cell = cellOf(codepoint);
+      if (cell >= 0) {
+        if (cells[cell].frame != frame) {
+          cells[cell].frame = frame;
+          unlink(cell);
+          pushFront(cell);
+        }
+      } else if (cell == NOT_LOADED) {
+        rasterize(codepoint, frame);
+      }
+    });
+  }
+};
+
+inline Uint32
+TrueTypeFont::findTable(const char* tag) const
+{
+  int numTables = read16(4);
+  for (int i = 0; i < numTables; ++i) {
+    Uint32 record = 12 + 16 * i;
+    if (record + 16 <= data.size() && std::memcmp(&data[record], tag, 4) == 0) {
+      return read32(record + 8);
+    }
+  }
+  return 0;
+}
+
+inline void
+TrueTypeFont::init(int pixelHeight)
+{
+  std::fill(std::begin(latin1Cells), std::end(latin1Cells), NO_BITMAP);
+  Uint32 head = findTable("head");
+  Uint32 hhea = findTable("hhea");
+  Uint32 maxp = findTable("maxp");
+  glyf = findTable("glyf");
+  loca = findTable("loca");
+  hmtx = findTable("hmtx");
+  if (!head || !hhea || !maxp || !glyf || !loca || !hmtx) {
+    return;
+  }
+  longLoca = read16(head + 50) != 0;
+  numGlyphs = read16(maxp + 4);
+  numHMetrics = read16(hhea + 34);
+
+  // Prefer the full Unicode subtable (format 12) over the BMP one (format 4)
+  Uint32 table = findTable("cmap");
+  for (int i = 0, n = read16(table + 2); i < n; ++i) {
+    Uint32 record = table + 4 + 8 * i;
+    Uint32 platform = read16(record), encoding = read16(record + 2);
+    bool unicode =
+      platform == 0 || (platform == 3 && (encoding == 1 || encoding == 10));
+    if (!unicode) {
+      continue;
+    }
+    Uint32 subtable = table + read32(record + 4);
+    Uint32 format = read16(subtable);
+    if (format == 12 || (format == 4 && !cmap)) {
+      cmap = subtable;
+    }
+  }
+  if (!cmap || numHMetrics == 0) {
+    return;
+  }
+
+  int ascender = readS16(hhea + 4), descender = readS16(hhea + 6);
+  scale = float(pixelHeight) / std::max(ascender - descender, 1);
+  ascent = std::lround(ascender * scale);
+  lineHeight = pixelHeight;
+
+  // Cells fit the font bounding box, with a transparent border
+  cellW = std::ceil(readS16(head + 40) * scale) -
+          std::floor(readS16(head + 36) * scale) + 2;
+  cellH = std::ceil(readS16(head + 42) * scale) -
+          std::floor(readS16(head + 38) * scale) + 2;
+  cols = std::ceil(std::sqrt(float(capacity)));
+  int rows = (capacity + cols - 1) / cols;
+  texture = backend->createTexture(cols * cellW, rows * cellH);
+  if (!texture) {
+    return;
+  }
+
+  for (Uint32 ch = 0; ch < 256; ++ch) {
+    addGlyph(ch);
+  }
+  glyphs.fallback = {{0, 0, 0, 0}, advanceOf(0)};
+  cells.reserve(capacity);
+}
+
+inline int
+TrueTypeFont::advanceOf(int index) const
+{
+  int advance = read16(hmtx + 4 * std::min(index, numHMetrics - 1));
+  return std::lround(advance * scale);
+}
+
+inline void
+TrueTypeFont::addGlyph(Uint32 codepoint)
+{
+  glyphs[codepoint] = {{0, 0, 0, 0}, advanceOf(glyphIndex(codepoint))};
+  cellOf(codepoint) = NOT_LOADED;
+}
+
+inline int
+TrueTypeFont::glyphIndex(Uint32 codepoint) const
+{
+  if (read16(cmap) == 12) {
+    Uint32 groups = cmap + 16;
+    for (Uint32 i = 0, n = read32(cmap + 12); i < n; ++i) {
+      Uint32 group = groups + 12 * i;
+      Uint32 first = read32(group), last = read32(group + 4);
+      if (codepoint < first) {
+        break;
+      }
+      if (codepoint <= last) {
+        return read32(group + 8) + codepoint - first;
+      }
+    }
+    return 0;
+  }
+  if (codepoint > 0xffff) {
+    return 0;
+  }
+  Uint32 segCountX2 = read16(cmap + 6);
+  Uint32 endCodes = cmap + 14;
+  Uint32 startCodes = endCodes + segCountX2 + 2;
+  Uint32 idDeltas = startCodes + segCountX2;
+  Uint32 idRangeOffsets = idDeltas + segCountX2;
+  for (Uint32 i = 0; i < segCountX2; i += 2) {
+    if (codepoint > read16(endCodes + i)) {
+      continue;
+    }
+    Uint32 start = read16(startCodes + i);
+    if (codepoint < start) {
+      return 0;
+    }
+    Uint32 delta = read16(idDeltas + i);
+    Uint32 rangeOffset = read16(idRangeOffsets + i);
+    if (rangeOffset == 0) {
+      return (codepoint + delta) & 0xffff;
+    }
+    Uint32 index =
+      read16(idRangeOffsets + i + rangeOffset + 2 * (codepoint - start));
+    return index ? (index + delta) & 0xffff : 0;
+  }
+  return 0;
+}
+
+inline void
+TrueTypeFont::outline(int index, const Transform& t, int depth)
+{
+  if (index >= numGlyphs || depth > 8) {
+    return;
+  }
+  Uint32 offset, next;
+  if (longLoca) {
+    offset = read32(loca + 4 * index);
+    next = read32(loca + 4 * index + 4);
+  } else {
+    offset = read16(loca + 2 * index) * 2;
+    next = read16(loca + 2 * index + 2) * 2;
+  }
+  if (offset >= next) {
+    return; // No outline
+  }
+  Uint32 g = glyf + offset;
+  int numContours = readS16(g);
+
+  if (numContours < 0) {
+    // Composite, made of other glyphs
+    Uint32 p = g + 10;
+    Uint32 flags;
+    do {
+      flags = read16(p);
+      Transform c;
+      int component = read16(p + 2);
+      p += 4;
+      if (flags & 0x0001) {
+        c.dx = readS16(p);
+        c.dy = readS16(p + 2);
+        p += 4;
+      } else {
+        c.dx = Sint8(read8(p));
+        c.dy = Sint8(read8(p + 1));
+        p += 2;
+      }
+      if (!(flags & 0x0002)) {
+        c.dx = c.dy = 0; // Matching points are not supported
+      }
+      if (flags & 0x0008) {
+        c.a = c.d = readF2Dot14(p);
+        p += 2;
+      } else if (flags & 0x0040) {
+        c.a = readF2Dot14(p);
+        c.d = readF2Dot14(p + 2);
+        p += 4;
+      } else if (flags & 0x0080) {
+        c.a = readF2Dot14(p);
+        c.b = readF2Dot14(p + 2);
+        c.c = readF2Dot14(p + 4);
+        c.d = readF2Dot14(p + 6);
+        p += 8;
+      }
+      Transform combined{t.a * c.a + t.c * c.b,
+                         t.b * c.a + t.d * c.b,
+                         t.a * c.c + t.c * c.d,
+                         t.b * c.c + t.d * c.d,
+                         t.a * c.dx + t.c * c.dy + t.dx,
+                         t.b * c.dx + t.d * c.dy + t.dy};
+      outline(component, combined, depth + 1);
+    } while (flags & 0x0020);
+    return;
+  }
+
+  Uint32 endPts = g + 10;
+  int first = points.size();
+  int numPoints = numContours ? read16(endPts + 2 * numContours - 2) + 1 : 0;
+  for (int i = 0; i < numContours; ++i) {
+    contourEnds.push_back(first + read16(endPts + 2 * i) + 1);
+  }
+  Uint32 p = endPts + 2 * numContours;
+  p += 2 + read16(p); // Skip instructions
+
+  // Flags, with repetitions
+  flags.clear();
+  while (int(flags.size()) < numPoints) {
+    Uint8 flag = read8(p++);
+    int repeat = flag & 0x08 ? read8(p++) : 0;
+    flags.insert(
+      flags.end(), std::min(repeat + 1, numPoints - int(flags.size())), flag);
+  }
+
+  // Coordinates, each a delta from the previous one
+  auto delta = [&](Uint8 flag, Uint8 shortBit, Uint8 sameBit) {
+    if (flag & shortBit) {
+      int value = read8(p++);
+      return flag & sameBit ? value : -value;
+    }
+    if (flag & sameBit) {
+      return 0;
+    }
+    p += 2;
+    return readS16(p - 2);
+  };
+  points.resize(first + numPoints);
+  for (int i = 0, x = 0; i < numPoints; ++i) {
+    x += delta(flags[i], 0x02, 0x10);
+    points[first + i].x = x;
+    points[first + i].on = flags[i] & 0x01;
+  }
+  for (int i = 0, y = 0; i < numPoints; ++i) {
+    y += delta(flags[i], 0x04, 0x20);
+    points[first + i].y = y;
+  }
+  for (int i = first; i < first + numPoints; ++i) {
+    auto& pt = points[i];
+    float x = pt.x, y = pt.y;
+    pt.x = t.a * x + t.c * y + t.dx;
+    pt.y = t.b * x + t.d * y + t.dy;
+  }
+}
+
+// Accumulates the signed area covered by the line on each pixel, to be summed
+// along the rows later
+inline void
+TrueTypeFont::drawLine(Point p0, Point p1, int w, int h)
+{
+  if (p0.y == p1.y) {
+    return;
+  }
+  float dir = 1;
+  if (p0.y > p1.y) {
+    std::swap(p0, p1);
+    dir = -1;
+  }
+  int stride = w + 2;
+  float dxdy = (p1.x - p0.x) / (p1.y - p0.y);
+  float x = p0.x;
+  for (int y = p0.y, yEnd = std::min<int>(h, std::ceil(p1.y)); y < yEnd; ++y) {
+    float* row = &accumulation[y * stride];
+    float dy = std::min(y + 1.f, p1.y) - std::max(float(y), p0.y);
+    float xNext = x + dxdy * dy;
+    float d = dy * dir;
+    float x0 = std::min(x, xNext), x1 = std::max(x, xNext);
+    float x0Floor = std::floor(x0);
+    int x0i = x0Floor;
+    float x1Ceil = std::ceil(x1);
+    int x1i = x1Ceil;
+    if (x1i <= x0i + 1) {
+      float xm = 0.5f * (x + xNext) - x0Floor;
+      row[x0i] += d - d * xm;
+      row[x0i + 1] += d * xm;
+    } else {
+      float s = 1 / (x1 - x0);
+      float x0f = x0 - x0Floor;
+      float a0 = 0.5f * s * (1 - x0f) * (1 - x0f);
+      float x1f = x1 - x1Ceil + 1;
+      float am = 0.5f * s * x1f * x1f;
+      row[x0i] += d * a0;
+      if (x1i == x0i + 2) {
+        row[x0i + 1] += d * (1 - a0 - am);
+      } else {
+        float a1 = s * (1.5f - x0f);
+        row[x0i + 1] += d * (a1 - a0);
+        for (int xi = x0i + 2; xi < x1i - 1; ++xi) {
+          row[xi] += d * s;
+        }
+        float a2 = a1 + (x1i - x0i - 3) * s;
+        row[x1i - 1] += d * (1 - a2 - am);
+      }
+      row[x1i] += d * am;
+    }
+    x = xNext;
+  }
+}
+
+inline void
+TrueTypeFont::drawQuad(Point p0, Point p1, Point p2, int w, int h)
+{
+  float devX = p0.x - 2 * p1.x + p2.x;
+  float devY = p0.y - 2 * p1.y + p2.y;
+  float devSq = devX * devX + devY * devY;
+  if (devSq < 0.333f) {
+    drawLine(p0, p2, w, h);
+    return;
+  }
+  int n = 1 + std::floor(std::sqrt(std::sqrt(3 * devSq)));
+  Point prev = p0;
+  for (int i = 1; i <= n; ++i) {
+    float t = float(i) / n, u = 1 - t;
+    Point next{u * u * p0.x + 2 * u * t * p1.x + t * t * p2.x,
+               u * u * p0.y + 2 * u * t * p1.y + t * t * p2.y,
+               true};
+    drawLine(prev, next, w, h);
+    prev = next;
+  }
+}
+
+inline void
+TrueTypeFont::rasterize(Uint32 codepoint, Uint32 frame)
+{
+  points.clear();
+  contourEnds.clear();
+  outline(glyphIndex(codepoint), {}, 0);
+  if (points.empty()) {
+    cellOf(codepoint) = NO_BITMAP;
+    return;
+  }
+
+  // Find a cell
+  int cell;
+  if (int(cells.size()) < capacity) {
+    cell = cells.size();
+    cells.push_back({});
+  } else if (cells[tail].frame != frame) {
+    cell = tail;
+    unlink(cell);
+    Uint32 evicted = cells[cell].codepoint;
+    glyphs[evicted].srcRect = {0, 0, 0, 0};
+    cellOf(evicted) = NOT_LOADED;
+  } else {
+    ++missCount;
+    return;
+  }
+  cells[cell].codepoint = codepoint;
+  cells[cell].frame = frame;
+  pushFront(cell);
+  cellOf(codepoint) = cell;
+
+  // Bitmap bounds, in pixels with y growing down
+  float minX = points[0].x, maxX = minX, minY = points[0].y, maxY = minY;
+  for (auto& pt : points) {
+    minX = std::min(minX, pt.x);
+    maxX = std::max(maxX, pt.x);
+    minY = std::min(minY, pt.y);
+    maxY = std::max(maxY, pt.y);
+  }
+  int x0 = std::floor(minX * scale), y0 = std::floor(-maxY * scale);
+  int w = std::min<int>(std::ceil(maxX * scale) - x0, cellW - 2);
+  int h = std::min<int>(std::ceil(-minY * scale) - y0, cellH - 2);
+  for (auto& pt : points) {
+    pt.x = std::clamp(pt.x * scale - x0, 0.f, float(w));
+    pt.y = std::clamp(-pt.y * scale - y0, 0.f, float(h));
+  }
+
+  accumulation.assign((w + 2) * h, 0.f);
+  int start = 0;
+  for (int end : contourEnds) {
+    if (end - start < 2) {
+      start = end;
+      continue;
+    }
+    // Walk from an on curve point, implied between the first and last ones
+    // if both are control points
+    Point origin = points[start];
+    int from = start + 1, to = end;
+    if (!origin.on) {
+      from = start;
+      if (points[end - 1].on) {
+        origin = points[--to];
+      } else {
+        origin = {(points[start].x + points[end - 1].x) / 2,
+                  (points[start].y + points[end - 1].y) / 2,
+                  true};
+      }
+    }
+    Point prev = origin, control;
+    bool hasControl = false;
+    for (int i = from; i < to; ++i) {
+      auto& pt = points[i];
+      if (pt.on) {
+        if (hasControl) {
+          drawQuad(prev, control, pt, w, h);
+        } else {
+          drawLine(prev, pt, w, h);
+        }
+        prev = pt;
+        hasControl = false;
+      } else {
+        if (hasControl) {
+          Point mid{(control.x + pt.x) / 2, (control.y + pt.y) / 2, true};
+          drawQuad(prev, control, mid, w, h);
+          prev = mid;
+        }
+        control = pt;
+        hasControl = true;
+      }
+    }
+    if (hasControl) {
+      drawQuad(prev, control, origin, w, h);
+    } else {
+      drawLine(prev, origin, w, h);
+    }
+    start = end;
+  }
+
+  // Sum the rows into the cell pixels, leaving its border transparent
+  pixels.assign(cellW * cellH, {255, 255, 255, 0});
+  for (int y = 0; y < h; ++y) {
+    float sum = 0;
+    for (int x = 0; x < w; ++x) {
+      sum += accumulation[y * (w + 2) + x];
+      auto alpha = std::min(std::abs(sum), 1.f);
+      pixels[(y + 1) * cellW + x + 1].a = Uint8(alpha * 255 + 0.5f);
+    }
+  }
+  SDL_Rect rect{cell % cols * cellW, cell / cols * cellH, cellW, cellH};
+  backend->updateTexture(texture, rect, pixels.data(), cellW * 4);
+  auto& glyph = glyphs[codepoint];
+  glyph.srcRect = {rect.x + 1, rect.y + 1, w, h};
+  glyph.offset = {x0, ascent + y0};
+}
+
+inline void
+TrueTypeFont::unlink(int cell)
+{
+  auto& c = cells[cell];
+  (c.prev >= 0 ? cells[c.prev].next : head) = c.next;
+  (c.next >= 0 ? cells[c.next].prev : tail) = c.prev;
+}
+
+inline void
+TrueTypeFont::pushFront(int cell)
+{
+  cells[cell].prev = -1;
+  cells[cell].next = head;
+  (head >= 0 ? cells[head].prev : tail) = cell;
+  head = cell;
+}
+
+} // namespace dui
+
+#endif // DUI_TRUE_TYPE_FONT_HPP
@@ -0,0 +1,222 @@
+#ifndef DUI_UTF8_HPP
+#define DUI_UTF8_HPP
+
+#include <cstring>
+#include <string_view>
+#include <SDL.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || _M_IX86_FP >= 2
+#include <emmintrin.h>
+#endif
+
+/// If true, ASCII runs are found 16 bytes at a time with SSE2
+#ifndef DUI_UTF8_SSE2
+#if defined(__SSE2__) || defined(_M_X64) || _M_IX86_FP >= 2
+#define DUI_UTF8_SSE2 1
+#else
+#define DUI_UTF8_SSE2 0
+#endif
+#endif
+
+namespace dui {
+
+/// Decoded in place of invalid sequences
+constexpr Uint32 REPLACEMENT_CHARACTER = 0xfffd;
+
+/**
+ * @brief The number of bytes before the first non ASCII one
+ *
+ * Most text is ASCII, so it is checked in blocks of 16 (with SSE2) or 8 bytes
+ * before decoding anything.
+ */
+inline size_t
+asciiPrefix(std::string_view str)
+{
+  const char* p = str.data();
+  size_t n = str.size(), i = 0;
+#if DUI_UTF8_SSE2
+  for (; i + 16 <= n; i += 16) {
+    auto block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+    if (_mm_movemask_epi8(block) != 0) {
+      break;
+    }
+  }
+#endif
+  for (; i + 8 <= n; i += 8) {
+    Uint64 block;
+    std::memcpy(&block, p + i, 8);
+    if (block & 0x8080808080808080ull) {
+      break;
+    }
+  }
+  while (i < n && Uint8(p[i]) < 0x80) {
+    ++i;
+  }
+  return i;
+}
+
+/**
+ * @brief Decode the code point starting at pos and move pos past it
+ *
+ * Invalid, overlong and truncated sequences decode as REPLACEMENT_CHARACTER,
+ * consuming a single byte.
+ *
+ * @param str the UTF-8 text
+ * @param pos the position, must be less than str.size()
+ * @return the code point
+ */
+constexpr Uint32
+decodeUtf8(std::string_view str, size_t& pos)
+{
+  Uint8 lead = str[pos++];
+  if (lead < 0x80) {
+    return lead;
+  }
+  int count = 0;
+  Uint32 codepoint = 0, min = 0;
+  if ((lead & 0xe0) == 0xc0) {
+    count = 1;
+    codepoint = lead & 0x1f;
+    min = 0x80;
+  } else if ((lead & 0xf0) == 0xe0) {
+    count = 2;
+    codepoint = lead & 0x0f;
+    min = 0x800;
+  } else if ((lead & 0xf8) == 0xf0) {
+    count = 3;
+    codepoint = lead & 0x07;
+    min = 0x10000;
+  } else {
+    return REPLACEMENT_CHARACTER;
+  }
+  if (pos + count > str.size()) {
+    return REPLACEMENT_CHARACTER;
+  }
+  for (int i = 0; i < count; ++i) {
+    Uint8 next = str[pos + i];
+    if ((next & 0xc0) != 0x80) {
+      return REPLACEMENT_CHARACTER;
+    }
+    codepoint = codepoint << 6 | (next & 0x3f);
+  }
+  if (codepoint < min || codepoint > 0x10ffff ||
+      (codepoint >= 0xd800 && codepoint <= 0xdfff)) {
+    return REPLACEMENT_CHARACTER;
+  }
+  pos += count;
+  return codepoint;
+}
+
+/**
+ * @brief Encode a code point as UTF-8
+ *
+ * @param codepoint the code point. Invalid ones are encoded as
+ * REPLACEMENT_CHARACTER
+ * @param out where to write, with room for 4 bytes
+ * @return the number of bytes written
+ */
+constexpr size_t
+encodeUtf8(Uint32 codepoint, char* out)
+{
+  if (codepoint > 0x10ffff || (codepoint >= 0xd800 && codepoint <= 0xdfff)) {
+    codepoint = REPLACEMENT_CHARACTER;
+  }
+  if (codepoint < 0x80) {
+    out[0] = char(codepoint);
+    return 1;
+  }
+  if (codepoint < 0x800) {
+    out[0] = char(0xc0 | codepoint >> 6);
+    out[1] = char(0x80 | (codepoint & 0x3f));
+    return 2;
+  }
+  if (codepoint < 0x10000) {
+    out[0] = char(0xe0 | codepoint >> 12);
+    out[1] = char(0x80 | (codepoint >> 6 & 0x3f));
+    out[2] = char(0x80 | (codepoint & 0x3f));
+    return 3;
+  }
+  out[0] = char(0xf0 | codepoint >> 18);
+  out[1] = char(0x80 | (codepoint >> 12 & 0x3f));
+  out[2] = char(0x80 | (codepoint >> 6 & 0x3f));
+  out[3] = char(0x80 | (codepoint & 0x3f));
+  return 4;
+}
+
+/**
+ * @brief Call f(codepoint) for each code point in str
+ *
+ * ASCII runs skip the decoder entirely.
+ */
+template<class F>
+inline void
+forEachCodepoint(std::string_view str, F f)
+{
+  size_t pos = 0;
+  while (pos < str.size()) {
+    size_t end = pos + asciiPrefix(str.substr(pos));
+    for (; pos < end; ++pos) {
+      f(Uint32(Uint8(str[pos])));
+    }
+    if (pos < str.size()) {
+      f(decodeUtf8(str, pos));
+    }
+  }
+}
+
+/// The number of code points in str
+inline size_t
+utf8Length(std::string_view str)
+{
+  size_t count = 0, pos = 0;
+  while (pos < str.size()) {
+    size_t ascii = asciiPrefix(str.substr(pos));
+    count += ascii;
+    pos += ascii;
+    if (pos < str.size()) {
+      decodeUtf8(str, pos);
+      ++count;
+    }
+  }
+  return count;
+}
+
+/**
+ * @brief The byte offset of a code point
+ *
+ * @param str the UTF-8 text
+ * @param index the code point index
+ * @return the offset, or str.size() if there are not so many code points
+ */
+inline size_t
+utf8Offset(std::string_view str, size_t index)
+{
+  size_t pos = 0;
+  while (index > 0 && pos < str.size()) {
+    size_t ascii = asciiPrefix(str.substr(pos, index));
+    pos += ascii;
+    index -= ascii;
+    if (index > 0 && pos < str.size()) {
+      decodeUtf8(str, pos);
+      --index;
+    }
+  }
+  return pos;
+}
+
+/// The largest size not greater than n that does not split a sequence
+constexpr size_t
+utf8Truncate(std::string_view str, size_t n)
+{
+  if (n >= str.size()) {
+    return str.size();
+  }
+  while (n > 0 && (Uint8(str[n]) & 0xc0) == 0x80) {
+    --n;
+  }
+  return n;
+}
+
+} // namespace dui
+
+#endif // DUI_UTF8_HPP
@@ -0,0 +1,82 @@
+#ifndef DUI_VIRTUALLIST_HPP_
+#define DUI_VIRTUALLIST_HPP_
+
+#include <algorithm>
+#include <climits>
+#include <string_view>
+#include <SDL.h>
+#include "Group.hpp"
+#include "Scrollable.hpp"
+#include "ScrollableStyle.hpp"
+#include "Theme.hpp"
+
+namespace dui {
+
+/**
+ * @brief A scrollable list of rows with the same height
+ * @ingroup groups
+ *
+ * Only the rows intersecting the visible area are created, so the cost per
+ * frame does not depend on count. The scroll bars are sized as if all rows
+ * were there.
+ *
+ * Each row is a vertical group with its index as id, so elements on
+ * different rows can share ids.
+ *
+ * @param target the parent group or frame
+ * @param id the id
+ * @param scrollOffset the scrolling control variable
+ * @param count the number of rows
+ * @param rowHeight the height of each row
+ * @param row the callback adding a row's elements, called as row(target,
+ * index)
+ * @param r the relative position and the size. If size is 0 it will use a
+ * default size, as in scrollable()
+ * @param style
+ */
+template<class ROW>
+inline void
+virtualList(Target target,
+            std::string_view id,
+            SDL_Point* scrollOffset,
+            size_t count,
+            int rowHeight,
+            ROW row,
+            const SDL_Rect& r = {0},
+            const ScrollableStyle& style = themeFor<Scrollable>())
+{
+  SDL_assert(scrollOffset != nullptr && rowHeight > 0);
+  if (count == 0) {
+    // An empty list has nothing to scroll to
+    scrollOffset->y = 0;
+  }
+  auto s = scrollable(
+    target, id, scrollOffset, r, style.withLayout(Layout::NONE));
+  Target client = s;
+  int width = client.width();
+  int scrollY = std::max(scrollOffset->y, 0);
+  size_t first = scrollY / rowHeight;
+  size_t last = std::min<Sint64>(
+    count, (Sint64(scrollY) + client.height() + rowHeight - 1) / rowHeight);
+
+  char rowId[24];
+  for (size_t i = first; i < last; ++i) {
+    SDL_ulltoa(i, rowId, 10);
+    auto g = group(client,
+                   rowId,
+                   {0, int(i * rowHeight), width, rowHeight},
+                   Layout::VERTICAL);
+    row(g, i);
+    g.end();
+  }
+
+  // Pretend all rows were added, as far as int coordinates go
+  Sint64 height = Sint64(count) * rowHeight;
+  int maxHeight = INT_MAX - std::max(client.getCaret().y, 0);
+  client.advance({width, int(std::min<Sint64>(height, maxHeight))});
+  s.end();
+}
+
+} // namespace dui
+
+#endif // DUI_VIRTUALLIST_HPP_
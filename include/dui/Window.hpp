@@ -74,31 +74,13 @@ public:
   /// Returns a target object to this
   operator Target() & { return wrapper; }
 
+  /// The size at the end of the last frame, known before adding the content
+  SDL_Point lastSize() const { return wrapper.lastSize(); }
+
   /// Returns true if it can accept elements
   operator bool() const { return wrapper; }
 };
 
-/// Makes window size accordingly to parameters
-inline SDL_Point
-makeWindowSize(SDL_Point defaultSize, Target target)
-{
-  if (defaultSize.x == 0 && target.getLayout() == Layout::VERTICAL) {
-    defaultSize.x = target.width();
-  }
-  if (defaultSize.y == 0 && target.getLayout() == Layout::HORIZONTAL) {
-    defaultSize.y = target.height();
-  }
-  return defaultSize;
-}
-
-/// Makes window rect accordingly to parameters
-inline SDL_Rect
-makeWindowRect(const SDL_Rect& r, Target target)
-{
-  auto sz = makeWindowSize({r.w, r.h}, target);
-  return {r.x, r.y, sz.x, sz.y};
-}
-
 /**
  * @brief adds an window element
  * @ingroup groups
@@ -122,8 +104,8 @@ window(Target target,
     target,
     id,
     title,
-    makeWindowRect(r, target),
-    [style](auto t, auto r) { return group(t, "client", r, style); },
+    r,
+    [&style](auto t, auto r) { return group(t, "client", r, style); },
     style,
   };
 }
@@ -173,8 +155,8 @@ window(Target target,
  * @param target the parent group or frame
  * @param id the id
  * @param scrollOffset the scrolling control variable
- * @param r the relative position and the size. If size is 0 it will use a
- * default size. Notice that this is different from group() and panel() behavior
+ * @param r the relative position and the size. If w or h is 0 it fills the
+ * parent across its layout, as panel(), or else it uses a default size
  * @param layout
  * @param style
  * @return group
@@ -192,7 +174,7 @@ scrollableWindow(
           id,
           title,
           makeScrollableRect(r, target),
-          [=](auto t, auto r) {
+          [&](auto t, auto r) {
             return scrollable(t, "client", scrollOffset, r, style);
           },
           style};
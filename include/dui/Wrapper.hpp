@@ -1,23 +1,77 @@
 #pragma once
 
-#include <functional>
+#include <algorithm>
 #include "EdgeSize.hpp"
 #include "Group.hpp"
 
 namespace dui {
 
-/// A class to make wrapper elements
+/**
+ * @brief The size a wrapper auto sized across the parent's layout fills
+ *
+ * It is the parent's fixed size, or the largest of its current and last frame
+ * sizes. It can be 0 on the first frame of an auto sized parent.
+ */
+inline SDL_Point
+makeFillSize(Target parent)
+{
+  auto& parentRect = parent.getRect();
+  SDL_Point size{parentRect.w, parentRect.h};
+  if (size.x == 0 || size.y == 0) {
+    auto lastSize = parent.lastSize();
+    if (size.x == 0) {
+      size.x = std::max(parent.width(), lastSize.x);
+    }
+    if (size.y == 0) {
+      size.y = std::max(parent.height(), lastSize.y);
+    }
+  }
+  return size;
+}
+
+/**
+ * @brief A class to make wrapper elements
+ *
+ * An auto sized dimension across the parent's layout (the width on a vertical
+ * one, the height on a horizontal one) fills the parent, using the size it
+ * had on the last frame if larger than its current one. Only the content size
+ * is taken on the parent along it, so the parent can still shrink.
+ *
+ * CLIENT is built once, by the initializer given to the constructor. It must
+ * be movable and have a retarget() method, called when the wrapper moves, as
+ * the client is a child of the wrapper's decoration.
+ */
 template<class CLIENT>
 class Wrapper : public Targetable<Wrapper<CLIENT>>
 {
-  using ClientInitializer = std::function<CLIENT(Target, const SDL_Rect&)>;
   EdgeSize padding;
-  ClientInitializer initializer;
+  State* state;
+  Id qualifiedId;
+  bool fillW;
+  bool fillH;
   Group decoration;
   CLIENT client;
   bool onClient = false;
   bool autoW;
   bool autoH;
+  SDL_Point extent{0, 0};
+
+  static SDL_Rect filledRect(SDL_Rect rect,
+                             Target parent,
+                             bool fillW,
+                             bool fillH)
+  {
+    if (fillW || fillH) {
+      auto size = makeFillSize(parent);
+      if (fillW) {
+        rect.w = size.x;
+      }
+      if (fillH) {
+        rect.h = size.y;
+      }
+    }
+    return rect;
+  }
 
   static constexpr SDL_Rect paddedSize(const SDL_Rect& rect,
                                        const EdgeSize& padding)
@@ -30,30 +84,52 @@ class Wrapper : public Targetable<Wrapper<CLIENT>>
   }
 
 public:
+  /**
+   * @brief Ctor
+   *
+   * @param initializer called once as initializer(target, rect) to create the
+   * client, on target, the decoration, with rect inside its padding
+   */
+  template<class FUNC>
   Wrapper(Target parent,
           std::string_view id,
           const SDL_Rect& rect,
           const EdgeSize& padding,
-          ClientInitializer initializer)
+          FUNC&& initializer)
     : padding(padding)
-    , initializer(initializer)
-    , decoration(parent, id, {0}, rect, {0, Layout::NONE})
-    , client(this->initializer(decoration, paddedSize(rect, padding)))
-    , autoW(rect.w == 0)
-    , autoH(rect.h == 0)
+    , state(&parent.getState())
+    , qualifiedId(state->idFor(id))
+    , fillW(rect.w == 0 && parent.getLayout() == Layout::VERTICAL)
+    , fillH(rect.h == 0 && parent.getLayout() == Layout::HORIZONTAL)
+    , decoration(parent,
+                 id,
+                 {0},
+                 filledRect(rect, parent, fillW, fillH),
+                 {0, Layout::NONE})
+    , client(initializer(Target{decoration},
+                         paddedSize(decoration.getRect(), padding)))
+    , autoW(decoration.getRect().w == 0)
+    , autoH(decoration.getRect().h == 0)
   {
     onClient = true;
   }
   Wrapper(const Wrapper&) = delete;
   Wrapper(Wrapper&& rhs)
     : padding(rhs.padding)
-    , initializer(rhs.initializer)
+    , state(rhs.state)
+    , qualifiedId(std::move(rhs.qualifiedId))
+    , fillW(rhs.fillW)
+    , fillH(rhs.fillH)
     , decoration(std::move(rhs.decoration))
-    , client(initializer(decoration, paddedSize(decoration.getRect(), padding)))
+    , client(std::move(rhs.client))
     , onClient(rhs.onClient)
     , autoW(rhs.autoW)
     , autoH(rhs.autoH)
+    , extent(rhs.extent)
   {
+    if (onClient) {
+      client.retarget(decoration);
+    }
     rhs.onClient = false;
   }
   Wrapper& operator=(const Wrapper& rhs) = delete;
@@ -75,12 +151,18 @@ public:
   operator Target() & { return onClient ? Target{client} : Target{decoration}; }
   operator bool() const { return onClient || bool(decoration); }
 
+  /// The size at the end of the last frame, known before adding the content
+  SDL_Point lastSize() const { return state->lastSize(qualifiedId); }
+
   SDL_Point endClient();
 
+  /// Set the parent, after it was moved
+  void retarget(Target parent) { decoration.retarget(parent); }
+
   void end()
   {
     SDL_assert(!onClient);
-    decoration.end();
+    decoration.end(extent);
   }
 };
 
@@ -89,6 +171,12 @@ inline SDL_Point
 Wrapper<CLIENT>::endClient()
 {
   SDL_assert(onClient);
+  SDL_Point content;
+  {
+    Target target{client};
+    content = {target.contentWidth() + padding.left + padding.right,
+               target.contentHeight() + padding.top + padding.bottom};
+  }
   if (autoW) {
     decoration.setWidth(client.width() + padding.left + padding.right);
   }
@@ -97,7 +185,10 @@ Wrapper<CLIENT>::endClient()
   }
   client.end();
   onClient = false;
-  return {decoration.width(), decoration.height()};
+  SDL_Point size{decoration.width(), decoration.height()};
+  extent = {fillW && !autoW ? content.x : size.x,
+            fillH && !autoH ? content.y : size.y};
+  return size;
 }
 
 } // namespace dui
@@ -2,19 +2,31 @@
 #define DUI_HPP_
 
 #include "Button.hpp"
+#include "CachedGroup.hpp"
 #include "DisplayList.hpp"
 #include "Element.hpp"
 #include "Font.hpp"
 #include "Frame.hpp"
+#include "FrameArena.hpp"
+#include "FrameStats.hpp"
 #include "Group.hpp"
 #include "InputBox.hpp"
 #include "InputField.hpp"
 #include "Label.hpp"
 #include "Panel.hpp"
+#include "PerfOverlay.hpp"
+#include "RenderBackend.hpp"
+#include "RuntimeTheme.hpp"
 #include "Scrollable.hpp"
 #include "SliderBox.hpp"
 #include "SliderField.hpp"
+#include "SoftRenderer.hpp"
 #include "State.hpp"
+#include "TextArea.hpp"
+#include "TextBuffer.hpp"
+#include "TrueTypeFont.hpp"
+#include "Utf8.hpp"
+#include "VirtualList.hpp"
 #include "Window.hpp"
 #include "Wrapper.hpp"
 
@@ -1,8 +1,15 @@
 const fs = require('fs')
 
+// An #if block made only of system includes
+const conditionalIncludeRegex = /^#if.*\n(?:#include <.*>\n)+#endif.*$/gm
+
 const cwd = process.cwd()
 const fileQueue = makeQueue('dui.hpp')
 
+const sources = fileQueue.map(fileName => stripGuard(fs.readFileSync(fileName, 'utf-8')))
+const conditionalIncludes = collectConditionalIncludes(sources)
+const systemIncludes = collectSystemIncludes(sources)
+
 const output = fs.openSync(process.argv[2], 'w')
 fs.writeSync(output, "/*\n * ", undefined)
 const copywrite = fs.readFileSync('../../LICENSE', 'utf-8')
@@ -10,21 +17,19 @@ fs.writeSync(output, copywrite.replace(/\n/g, '\n * '))
 fs.writeSync(output, "\n */\n", undefined)
 fs.writeSync(output, "#ifndef DUI_SINGLE_HPP\n", undefined)
 fs.writeSync(output, "#define DUI_SINGLE_HPP\n\n", undefined)
-fs.writeSync(output, "#include <algorithm>\n", undefined)
-fs.writeSync(output, "#include <string>\n", undefined)
-fs.writeSync(output, "#include <string_view>\n", undefined)
-fs.writeSync(output, "#include <vector>\n", undefined)
-fs.writeSync(output, "#include <SDL.h>\n\n", undefined)
-fs.writeSync(output, "namespace dui {\n\n", undefined)
-fs.writeSync(output, "#ifndef DUI_THEME\n", undefined)
-fs.writeSync(output, "#define DUI_THEME dui::style::SteelBlue\n", undefined)
-fs.writeSync(output, "#endif\n\n", undefined)
+for (const include of systemIncludes) {
+  fs.writeSync(output, `#include ${include}\n`)
+}
+for (const block of conditionalIncludes) {
+  fs.writeSync(output, `${block}\n`)
+}
+fs.writeSync(output, "\nnamespace dui {\n\n", undefined)
 
-for (const fileName of fileQueue) {
-  fs.writeSync(output, `// begin ${fileName}\n`)
-  const content = fs.readFileSync(fileName, 'utf-8')
-  fs.writeSync(output, content
-    .replace(/^#.*$/gm, '')
+for (let i = 0; i < fileQueue.length; ++i) {
+  fs.writeSync(output, `// begin ${fileQueue[i]}\n`)
+  fs.writeSync(output, sources[i]
+    .replace(/^#include .*$/gm, '')
+    .replace(/^#pragma once$/gm, '')
     .replace(/^namespace dui \{$/gm, '')
     .replace(/^\} \/\/ namespace dui$/gm, '')
     .trim()
@@ -37,6 +42,55 @@ fs.writeSync(output, "} // namespace dui\n\n", undefined)
 fs.writeSync(output, "#endif // DUI_SINGLE_HPP\n", undefined)
 
 
+/**
+ * Remove the include guard, if any, keeping other preprocessor directives
+ *
+ * @param {string} content
+ */
+function stripGuard(content) {
+  const m = content.match(/^\s*#ifndef (\w+)\s*\n#define (\w+)\s*\n/)
+  if (!m || m[1] !== m[2]) {
+    return content
+  }
+  content = content.slice(m[0].length)
+  const end = content.lastIndexOf('#endif')
+  return content.slice(0, end) + content.slice(end).replace(/^#endif.*$/m, '')
+}
+
+/**
+ * Gather the #if blocks made only of system includes, to keep them with their
+ * conditions outside the namespace
+ *
+ * @param {string[]} sources
+ */
+function collectConditionalIncludes(sources) {
+  const blocks = new Set()
+  for (const content of sources) {
+    for (const m of content.matchAll(conditionalIncludeRegex)) {
+      blocks.add(m[0])
+    }
+  }
+  return [...blocks]
+}
+
+/**
+ * Gather the unconditional system includes, so they can be put outside the
+ * namespace
+ *
+ * @param {string[]} sources
+ */
+function collectSystemIncludes(sources) {
+  const standard = new Set()
+  const others = new Set()
+  for (let content of sources) {
+    content = content.replace(conditionalIncludeRegex, '')
+    for (const m of content.matchAll(/^#include (<(.*)>)$/gm)) {
+      (m[2].includes('.') ? others : standard).add(m[1])
+    }
+  }
+  return [...[...standard].sort(), ...[...others].sort()]
+}
+
 /**
  * 
  * @param {string} file